@@ -0,0 +1,437 @@
+/// @file AesopARAstar.h
+/// Implementation of regressive anytime repairing A* (ARA*) search algorithm.
+
+#ifndef _AE_ARASTAR_H_
+#define _AE_ARASTAR_H_
+
+#include <vector>
+#include "abstract/AesopWorldState.h"
+#include "abstract/AesopActionSet.h"
+#include "abstract/AesopObjects.h"
+#include "AesopProblem.h"
+#include "AesopPlan.h"
+#include "abstract/AesopContext.h"
+#include "AesopBudget.h"
+
+namespace Aesop {
+   /// Stores planner instance data used by the ARA* algorithm.
+   ///
+   /// The search runs in passes. Each pass is a weighted A* search whose
+   /// total cost is G + weight * H, so the plan it finds costs at most
+   /// weight times the optimum. Once a pass ends, the weight is lowered and
+   /// the next pass carries on from the states already discovered instead of
+   /// starting again.
+   ///
+   /// States are never removed from the closed list of the underlying
+   /// Problem. A closed state that is found by a cheaper route has its entry
+   /// updated in place, and is either reopened or, if it has already been
+   /// expanded in the current pass, remembered until the next pass.
+   ///
+   /// @ingroup Aesop
+   template < class WS, class H = GoalCountHeuristic >
+   struct ARAProblem {
+      /// Open and closed lists of the search.
+      Problem<WS, H> search;
+
+      /// Was a plan successfully created? This may become true before the
+      ///        search has finished, in which case the plan is valid but may
+      ///        not be the cheapest.
+      bool success;
+
+      /// Weight applied to the heuristic in the current pass. Once a pass
+      ///        has ended, the plan found costs at most this many times the
+      ///        cheapest plan.
+      float weight;
+
+      /// Amount the weight is lowered by after each pass.
+      float decrement;
+
+      /// Number of the current pass.
+      unsigned int pass;
+
+      /// Pass in which each closed list entry was last expanded.
+      std::vector<unsigned int> expanded;
+
+      /// Closed list entries that were given a cheaper route after being
+      ///        expanded in the current pass.
+      std::vector<unsigned int> incons;
+
+      /// Index in the closed list of the initial state once it has been
+      ///        reached, or HashIndex::None.
+      unsigned int found;
+
+      /// Default constructor.
+      /// @param[in] h Heuristic to guide the search with.
+      ARAProblem(const H &h = H())
+         : search(h),
+         success(false),
+         weight(1.0f),
+         decrement(1.0f),
+         pass(0),
+         found(HashIndex::None) {}
+   };
+
+   /// Initialise a regressive ARA* solution.
+   /// @param[in]  init      Initial world state for this problem.
+   /// @param[in]  goal      Desired world state for this problem.
+   /// @param[in]  weight    Heuristic weight to use in the first pass.
+   /// @param[in]  decrement Amount to lower the weight by after each pass.
+   /// @param[out] prob      Problem object to initialise.
+   /// @param[out] ctx       Context for logging and profiling.
+   /// @return True if initialisation was successful, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   bool ARAstarInit(const WS &init, const WS &goal, float weight, float decrement, ARAProblem<WS, H> &prob, Context &ctx)
+   {
+      // Check that the predicates used by each state match.
+      if(init.getPredicates() != goal.getPredicates())
+      {
+         //ctx.
+         return false;
+      }
+      ctx.beginPlanning();
+      // Goal is actually initial state since we're doing a regressive search.
+      prob.search.goal = &init;
+      // Clear problem data.
+      prob.search.reset();
+      prob.success = false;
+      prob.weight = weight < 1.0f ? 1.0f : weight;
+      prob.decrement = decrement;
+      prob.pass = 0;
+      prob.expanded.clear();
+      prob.incons.clear();
+      prob.found = HashIndex::None;
+      // Push the first state onto the open list.
+      typename Problem<WS, H>::openstate s;
+      s.state = prob.search.store(goal);
+      prob.search.push(s);
+      return true;
+   }
+
+   /// Give a closed list entry the route taken by another state.
+   /// @param     c Closed list entry to update.
+   /// @param[in] s State with the new route.
+   /// @ingroup Aesop
+   template < class S >
+   void ARAstarReroute(S &c, const S &s)
+   {
+      c.cost = s.cost;
+      c.G = s.G;
+      c.H = s.H;
+      c.parent = s.parent;
+      c.action = s.action;
+      c.params = s.params;
+   }
+
+   /// Record a route to the initial state, keeping it if it is the cheapest
+   /// so far.
+   /// @param     prob Problem to operate on.
+   /// @param[in] id   ID of a node whose state equals the initial state.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   void ARAstarReached(ARAProblem<WS, H> &prob, unsigned int id)
+   {
+      Problem<WS, H> &search = prob.search;
+      if(prob.found == HashIndex::None)
+      {
+         prob.found = search.closed.size();
+         search.close(id);
+         prob.expanded.push_back(prob.pass);
+         prob.success = true;
+         return;
+      }
+      typename Problem<WS, H>::openstate &f = search.nodes[search.closed[prob.found]];
+      if(search.nodes[id].G < f.G)
+         ARAstarReroute(f, search.nodes[id]);
+   }
+
+   /// Finish the current pass and prepare the next one.
+   /// @param prob Problem to operate on.
+   /// @return True if there is another pass to run, false if the plan found
+   ///         is already the cheapest.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   bool ARAstarNextPass(ARAProblem<WS, H> &prob)
+   {
+      Problem<WS, H> &search = prob.search;
+      if(search.open.empty() && prob.incons.empty())
+      {
+         // Every state has been expanded by its cheapest route.
+         prob.weight = 1.0f;
+         return false;
+      }
+      if(prob.weight <= 1.0f)
+         return false;
+      prob.weight -= prob.decrement;
+      if(prob.weight < 1.0f)
+         prob.weight = 1.0f;
+      prob.pass++;
+      // Inconsistent states go back on the open list. They share the
+      // WorldState of their closed list entry.
+      std::vector<unsigned int>::const_iterator it;
+      for(it = prob.incons.begin(); it != prob.incons.end(); it++)
+      {
+         typename Problem<WS, H>::openstate s = search.nodes[search.closed[*it]];
+         if(search.findOpen(*s.state) != HashIndex::None)
+            continue;
+         search.push(s);
+      }
+      prob.incons.clear();
+      // Reweight every open state for the new pass.
+      typename Problem<WS, H>::list::const_iterator o;
+      for(o = search.open.begin(); o != search.open.end(); o++)
+      {
+         typename Problem<WS, H>::openstate &n = search.nodes[*o];
+         n.cost = n.G + prob.weight * n.H;
+      }
+      search.reorder();
+      return true;
+   }
+
+   /// Perform a single iteration in a regressive ARA* search. Each iteration
+   /// expands one state, or finishes the current pass.
+   /// @param     prob    Problem to operate on.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @param[out] ctx    Context for logging and profiling.
+   /// @return True if the algorithm should continue, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool ARAstarIteration(ARAProblem<WS, H> &prob, const AS &actions, const Objects &objects, Context &ctx)
+   {
+      ctx.beginIteration();
+      Problem<WS, H> &search = prob.search;
+
+      // The pass is over once nothing on the open list could lead to a
+      // cheaper plan under the current weight.
+      if(search.open.empty() ||
+         (prob.found != HashIndex::None &&
+          search.nodes[search.closed[prob.found]].G <= search.nodes[search.open.front()].cost))
+      {
+         if(prob.found == HashIndex::None)
+         {
+            ctx.failure();
+            ctx.endIteration();
+            return false;
+         }
+         bool more = ARAstarNextPass(prob);
+         if(!more)
+            ctx.success();
+         ctx.endIteration();
+         return more;
+      }
+
+      unsigned int id = search.pop();
+      ctx.toClosed(id);
+
+      if(ReachedGoal(*search.goal, *search.nodes[id].state))
+      {
+         ARAstarReached(prob, id);
+         ctx.endIteration();
+         return true;
+      }
+
+      // States seen in an earlier pass already have a closed list entry.
+      unsigned int k = search.findClosed(*search.nodes[id].state);
+      if(k == HashIndex::None)
+      {
+         k = search.closed.size();
+         search.close(id);
+         prob.expanded.push_back(prob.pass);
+      }
+      else
+      {
+         ARAstarReroute(search.nodes[search.closed[k]], search.nodes[id]);
+         prob.expanded[k] = prob.pass;
+      }
+      const typename Problem<WS, H>::openstate &s = search.nodes[search.closed[k]];
+
+      // Find the actions that could lead here.
+      bool exact = GetApplicable(actions, *s.state, true, search.applicable);
+
+      // Successors are generated in place, in the scratch state.
+      WS &next = search.scratch.begin(*s.state);
+
+      // For each action we can take
+      ActionSet::paramcombos &plist = search.combos;
+      const ActionSet::const_iterator last = ActionsEnd(actions);
+      ActionSet::const_iterator it;
+      for(it = nextBit(search.applicable, ActionsBegin(actions)); it < last; it = nextBit(search.applicable, it + 1))
+      {
+         // Get list of parameter combinations.
+         plist.clear();
+         GetParamList(actions, it, plist, objects);
+         ActionSet::paramcombos::const_iterator p;
+         // For each valid parameter combination:
+         for(p = plist.begin(); p != plist.end(); p++)
+         {
+            // If the action doesn't post-match this world state, continue.
+            if(!exact && !PostMatch(actions, it, *p, *s.state))
+               continue;
+            // Create a new world state by applying the action in reverse.
+            ApplyReverseScratch(actions, it, *p, search.scratch);
+            typename Problem<WS, H>::openstate n;
+            n.action = it;
+            n.params = *p;
+            n.parent = k;
+            // Calculate cost.
+            n.G = s.G + ActionCost(actions, it, *p, next);
+            n.H = search.heuristic(*search.goal, next);
+            n.cost = n.G + prob.weight * n.H;
+            if(ReachedGoal(*search.goal, next))
+            {
+               n.state = search.store(next);
+               ARAstarReached(prob, search.add(n));
+               search.scratch.undo();
+               continue;
+            }
+            // A closed state is only worth revisiting by a cheaper route.
+            unsigned int c = search.findClosed(next);
+            if(c != HashIndex::None)
+            {
+               search.scratch.undo();
+               typename Problem<WS, H>::openstate &old = search.nodes[search.closed[c]];
+               if(!(n.G < old.G))
+                  continue;
+               ARAstarReroute(old, n);
+               if(prob.expanded[c] == prob.pass)
+               {
+                  // Already expanded this pass; wait for the next one.
+                  prob.incons.push_back(c);
+                  continue;
+               }
+               n.state = old.state;
+            }
+            // Check whether state is already in the open list; if so, we may
+            // update its cost.
+            unsigned int oi = search.findOpen(c == HashIndex::None ? next : *n.state);
+            if(oi == HashIndex::None)
+            {
+               // Only now does the state need storage of its own.
+               if(c == HashIndex::None)
+                  n.state = search.store(next);
+               search.push(n);
+            }
+            else
+            {
+               // We've found a more efficient way of getting here.
+               if(n.G < search.nodes[search.open[oi]].G)
+                  search.improve(oi, n);
+            }
+            if(c == HashIndex::None)
+               search.scratch.undo();
+         }
+      }
+
+      ctx.endIteration();
+      return true;
+   }
+
+   /// Perform as many iterations of a regressive ARA* search as a budget
+   /// allows.
+   ///
+   /// A plan may be available even while the search is in progress; check
+   /// prob.success and use ARAstarPublish to retrieve it.
+   ///
+   /// @param     prob    Problem to operate on.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @param[in] budget  Limits on the work done by this step.
+   /// @param[out] ctx    Context for logging and profiling.
+   /// @return Status of the search after this step.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   SearchStatus ARAstarStep(ARAProblem<WS, H> &prob, const AS &actions, const Objects &objects, const Budget &budget, Context &ctx)
+   {
+      return BudgetedStep(ARAstarIteration<WS, H, AS>, prob, actions, objects, budget, ctx);
+   }
+
+   /// Replace the contents of a Plan with the best plan found so far.
+   /// @param[in]  prob Problem to operate on.
+   /// @param[out] plan Plan to operate on. Left empty if no plan has been
+   ///                  found yet.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   void ARAstarPublish(const ARAProblem<WS, H> &prob, Plan &plan)
+   {
+      plan.clear();
+      if(!prob.success)
+         return;
+      unsigned int i = prob.found;
+      while(i)
+      {
+         const typename Problem<WS, H>::openstate &n = prob.search.nodes[prob.search.closed[i]];
+         // Extract the action performed at this step and its parameters.
+         plan.push(n.action, n.params);
+         // Iterate.
+         i = n.parent;
+      }
+   }
+
+   /// Finalise an ARAProblem into a Plan. The search need not have finished.
+   /// @param[in]  prob Problem to operate on.
+   /// @param[out] plan Plan to operate on.
+   /// @param[out] ctx  Context for logging and profiling.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   void ARAstarFinalise(const ARAProblem<WS, H> &prob, Plan &plan, Context &ctx)
+   {
+      ARAstarPublish(prob, plan);
+      ctx.endPlanning();
+   }
+
+   /// Perform a regressive ARA* search until it finds the cheapest plan or
+   /// its budget runs out.
+   /// @param[in]  init      Initial world state.
+   /// @param[in]  goal      Desired world state.
+   /// @param[in]  actions   Set of actions to operate with.
+   /// @param[in]  objects   Set of objects that exist in the problem.
+   /// @param[in]  heuristic Heuristic to guide the search with.
+   /// @param[in]  weight    Heuristic weight to start with.
+   /// @param[in]  budget    Limits on the work done by the search.
+   /// @param[out] plan      Plan output. Holds the best plan found in the
+   ///                       time allowed.
+   /// @param[out] ctx       Context for logging and profiling.
+   /// @return True if a valid plan was found, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool ARAstarSolve(const WS &init, const WS &goal,
+                     const AS &actions,
+                     const Objects &objects,
+                     const H &heuristic,
+                     float weight,
+                     const Budget &budget,
+                     Plan &plan,
+                     Context &ctx)
+   {
+      // Initialise problem with initial and goal states.
+      ARAProblem<WS, H> prob(heuristic);
+      if(!ARAstarInit(init, goal, weight, 1.0f, prob, ctx))
+         return false;
+
+      // Iterate until the cheapest plan is found or time runs out.
+      ARAstarStep(prob, actions, objects, budget, ctx);
+
+      // Finalise and return success.
+      ARAstarFinalise(prob, plan, ctx);
+      return prob.success;
+   }
+
+   /// Perform a regressive ARA* search guided by the number of predicates
+   /// that differ from the initial state.
+   /// @see ARAstarSolve
+   /// @ingroup Aesop
+   template < class WS, class AS >
+   bool ARAstarSolve(const WS &init, const WS &goal,
+                     const AS &actions,
+                     const Objects &objects,
+                     float weight,
+                     const Budget &budget,
+                     Plan &plan,
+                     Context &ctx)
+   {
+      return ARAstarSolve(init, goal, actions, objects, GoalCountHeuristic(), weight, budget, plan, ctx);
+   }
+};
+
+#endif
@@ -0,0 +1,95 @@
+/// @file AesopArena.h
+/// Definition of Arena class template.
+
+#ifndef _AE_ARENA_H_
+#define _AE_ARENA_H_
+
+#include <vector>
+#include <new>
+
+namespace Aesop {
+   /// Append-only store of objects in fixed-size blocks of contiguous memory.
+   ///
+   /// Objects are referred to by their 32-bit index, and never move once
+   /// added, so pointers and references to them stay valid until the arena
+   /// is cleared or reset. Clearing destroys the objects but keeps the
+   /// blocks. Resetting keeps the objects too, and later additions are
+   /// assigned over them, so objects that own memory of their own (such as
+   /// a WorldState's packed words) can reuse it. An arena that is reset and
+   /// refilled allocates nothing once it has grown to the size it needs.
+   ///
+   /// @tparam T         Type of object stored. Needs no default constructor,
+   ///                   but must be copy-assignable.
+   /// @tparam BlockBits Log2 of the number of objects in each block.
+   /// @ingroup Aesop
+   template < class T, unsigned int BlockBits = 8 >
+   class Arena {
+   public:
+      /// Number of objects stored in each block.
+      static const unsigned int blockSize = 1u << BlockBits;
+
+      /// Copy an object into the arena.
+      /// @param[in] t Object to copy.
+      /// @return Index of the new object.
+      unsigned int add(const T &t)
+      {
+         if(mSize < mConstructed)
+            (*this)[mSize] = t;
+         else
+         {
+            if(mSize == mBlocks.size() * blockSize)
+               mBlocks.push_back(static_cast<T*>(::operator new(sizeof(T) * blockSize)));
+            new(&(*this)[mSize]) T(t);
+            mConstructed++;
+         }
+         return mSize++;
+      }
+
+      /// Get an object by its index.
+      T &operator[](unsigned int i)
+      { return mBlocks[i >> BlockBits][i & (blockSize - 1)]; }
+      const T &operator[](unsigned int i) const
+      { return mBlocks[i >> BlockBits][i & (blockSize - 1)]; }
+
+      /// Number of objects stored.
+      unsigned int size() const { return mSize; }
+
+      /// Destroy every object, keeping the blocks for reuse.
+      void clear()
+      {
+         for(unsigned int i = 0; i < mConstructed; i++)
+            (*this)[i].~T();
+         mSize = mConstructed = 0;
+      }
+
+      /// Empty the arena in constant time. The objects are kept alive to
+      ///        be assigned over by later additions.
+      void reset() { mSize = 0; }
+
+      /// Default constructor.
+      Arena() : mSize(0), mConstructed(0) {}
+
+      /// Default destructor.
+      ~Arena()
+      {
+         clear();
+         for(unsigned int b = 0; b < mBlocks.size(); b++)
+            ::operator delete(mBlocks[b]);
+      }
+
+   protected:
+   private:
+      /// Arenas own their blocks, so can't be copied.
+      Arena(const Arena &other);
+      Arena &operator=(const Arena &other);
+
+      /// Blocks of storage, each with room for blockSize objects.
+      std::vector<T*> mBlocks;
+      /// Number of objects stored.
+      unsigned int mSize;
+      /// Number of objects constructed, including any left by reset.
+      unsigned int mConstructed;
+   };
+};
+
+#endif
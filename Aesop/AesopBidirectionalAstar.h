@@ -0,0 +1,265 @@
+/// @file AesopBidirectionalAstar.h
+/// Implementation of bidirectional A* search algorithm.
+
+#ifndef _AE_BIDIRECTIONAL_ASTAR_H_
+#define _AE_BIDIRECTIONAL_ASTAR_H_
+
+#include <vector>
+#include "abstract/AesopWorldState.h"
+#include "abstract/AesopActionSet.h"
+#include "abstract/AesopObjects.h"
+#include "AesopProblem.h"
+#include "AesopPlan.h"
+#include "abstract/AesopContext.h"
+#include "AesopBudget.h"
+#include "AesopForwardAstar.h"
+#include "AesopReverseAstar.h"
+
+namespace Aesop {
+   /// Passes every event on to another Context, except the end of an
+   /// iteration. A bidirectional search runs each iteration of its halves
+   /// through one of these, so that it can report a meeting before it ends
+   /// the iteration itself.
+   /// @ingroup Aesop
+   class HeldIterationContext : public Context {
+   public:
+      virtual void success() { mCtx.success(); }
+      virtual void failure() { mCtx.failure(); }
+      virtual void toClosed(unsigned int ID) { mCtx.toClosed(ID); }
+      virtual void forgotten(unsigned int ID) { mCtx.forgotten(ID); }
+      virtual void beginPlanning() { mCtx.beginPlanning(); }
+      virtual void beginIteration() { mCtx.beginIteration(); }
+      virtual void endIteration() {}
+      virtual void endPlanning() { mCtx.endPlanning(); }
+
+      /// Default constructor.
+      /// @param[in] ctx Context to pass events on to.
+      HeldIterationContext(Context &ctx) : mCtx(ctx) {}
+
+   protected:
+   private:
+      /// Context that receives the events.
+      Context &mCtx;
+   };
+
+   /// Stores the two searches that make up a bidirectional search.
+   /// @ingroup Aesop
+   template < class WS, class H = GoalCountHeuristic >
+   struct BidirectionalProblem {
+      /// Search from the initial state towards the goal.
+      Problem<WS, H> forward;
+      /// Search from the goal state back towards the initial state.
+      Problem<WS, H> reverse;
+
+      /// Was a plan successfully created?
+      bool success;
+
+      /// Index in the forward closed list where the searches met, or
+      ///        HashIndex::None if the reverse search reached the initial
+      ///        state by itself.
+      unsigned int forwardMeet;
+      /// Index in the reverse closed list where the searches met, or
+      ///        HashIndex::None if the forward search reached the goal
+      ///        state by itself.
+      unsigned int reverseMeet;
+
+      /// Should the next iteration expand the forward search?
+      bool forwardTurn;
+
+      /// Default constructor.
+      /// @param[in] h Heuristic to guide both searches with.
+      BidirectionalProblem(const H &h = H())
+         : forward(h),
+         reverse(h),
+         success(false),
+         forwardMeet(HashIndex::None),
+         reverseMeet(HashIndex::None),
+         forwardTurn(true) {}
+   };
+
+   /// Initialise a bidirectional A* solution.
+   /// @param[in]  init Initial world state for this problem.
+   /// @param[in]  goal Desired world state for this problem.
+   /// @param[out] prob Problem object to initialise.
+   /// @param[out] ctx  Context for logging and profiling.
+   /// @return True if initialisation was successful, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   bool BidirectionalAstarInit(const WS &init, const WS &goal, BidirectionalProblem<WS, H> &prob, Context &ctx)
+   {
+      // Planning begins once for both searches, as it ends once when they
+      // are finalised together.
+      if(!ForwardAstarStart(init, goal, prob.forward) ||
+         !ReverseAstarStart(init, goal, prob.reverse))
+         return false;
+      ctx.beginPlanning();
+      prob.success = false;
+      prob.forwardMeet = prob.reverseMeet = HashIndex::None;
+      prob.forwardTurn = true;
+      return true;
+   }
+
+   /// Perform a single iteration in a bidirectional A* search.
+   ///
+   /// Each iteration expands one state from either the forward or reverse
+   /// search, alternating between them. The search stops as soon as a state
+   /// closed by the forward search satisfies one closed by the reverse
+   /// search, as ReachedGoal decides. For WorldStates that know every
+   /// predicate this means the two are equal. Partial states, such as those
+   /// regressed from a MaskedWorldState goal, meet any forward state that
+   /// has all the values they ask for. The plan found this way is not
+   /// guaranteed to be the cheapest. If one search runs out of states, the
+   /// other carries on alone.
+   ///
+   /// @param     prob    Problem to operate on.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @param[out] ctx    Context for logging and profiling.
+   /// @return True if the algorithm should continue, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool BidirectionalAstarIteration(BidirectionalProblem<WS, H> &prob, const AS &actions, const Objects &objects, Context &ctx)
+   {
+      if(prob.forward.open.empty() && prob.reverse.open.empty())
+      {
+         ctx.beginIteration();
+         ctx.failure();
+         ctx.endIteration();
+         return false;
+      }
+      // Skip a search that has nothing left to expand. The other one must
+      // have something, so the search below always expands a state.
+      bool forward = prob.forwardTurn;
+      if((forward ? prob.forward : prob.reverse).open.empty())
+         forward = !forward;
+      prob.forwardTurn = !forward;
+      Problem<WS, H> &self = forward ? prob.forward : prob.reverse;
+      Problem<WS, H> &other = forward ? prob.reverse : prob.forward;
+
+      // The iteration is ended below, once we know whether the searches met.
+      HeldIterationContext held(ctx);
+      if(forward)
+         ForwardAstarIteration(self, actions, objects, held);
+      else
+         ReverseAstarIteration(self, actions, objects, held);
+
+      unsigned int theirs = HashIndex::None;
+      if(!self.success)
+      {
+         // Look among the other search's closed states for one that meets
+         // the state we just closed.
+         const WS &state = *self.nodes[self.closed.back()].state;
+         theirs = forward ? other.findSatisfied(state) : other.findSatisfying(state);
+         if(theirs == HashIndex::None)
+         {
+            ctx.endIteration();
+            return true;
+         }
+         ctx.success();
+      }
+      // Otherwise we reached the other search's starting state without help.
+      ctx.endIteration();
+
+      unsigned int mine = self.closed.size() - 1;
+      prob.success = true;
+      prob.forwardMeet = forward ? mine : theirs;
+      prob.reverseMeet = forward ? theirs : mine;
+      return false;
+   }
+
+   /// Perform as many iterations of a bidirectional A* search as a budget allows.
+   /// @param     prob    Problem to operate on.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @param[in] budget  Limits on the work done by this step.
+   /// @param[out] ctx    Context for logging and profiling.
+   /// @return Status of the search after this step. Once the search is no
+   ///         longer in progress, the problem should be finalised.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   SearchStatus BidirectionalAstarStep(BidirectionalProblem<WS, H> &prob, const AS &actions, const Objects &objects, const Budget &budget, Context &ctx)
+   {
+      return BudgetedStep(BidirectionalAstarIteration<WS, H, AS>, prob, actions, objects, budget, ctx);
+   }
+
+   /// Finalise a completed BidirectionalProblem into a Plan.
+   /// @param[in]  prob Problem to operate on.
+   /// @param[out] plan Plan to operate on.
+   /// @param[out] ctx  Context for logging and profiling.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   void BidirectionalAstarFinalise(const BidirectionalProblem<WS, H> &prob, Plan &plan, Context &ctx)
+   {
+      if(prob.success)
+      {
+         unsigned int i;
+         // The forward half leads back to the initial state, so its steps
+         // are found last first, and put in order afterwards.
+         unsigned int first = plan.size();
+         i = prob.forwardMeet;
+         while(i && i != HashIndex::None)
+         {
+            const typename Problem<WS, H>::openstate &n = prob.forward.nodes[prob.forward.closed[i]];
+            plan.push(n.action, n.params);
+            i = n.parent;
+         }
+         plan.reverse(first);
+         // The reverse half leads forward to the goal state.
+         i = prob.reverseMeet;
+         while(i && i != HashIndex::None)
+         {
+            const typename Problem<WS, H>::openstate &n = prob.reverse.nodes[prob.reverse.closed[i]];
+            plan.push(n.action, n.params);
+            i = n.parent;
+         }
+      }
+      ctx.endPlanning();
+   }
+
+   /// Perform a complete bidirectional A* search.
+   /// @param[in]  init      Initial world state.
+   /// @param[in]  goal      Desired world state.
+   /// @param[in]  actions   Set of actions to operate with.
+   /// @param[in]  objects   Set of objects that exist in the problem.
+   /// @param[in]  heuristic Heuristic to guide both searches with.
+   /// @param[out] plan      Plan output.
+   /// @param[out] ctx       Context for logging and profiling.
+   /// @return True if a valid plan was found, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool BidirectionalAstarSolve(const WS &init, const WS &goal,
+                                const AS &actions,
+                                const Objects &objects,
+                                const H &heuristic,
+                                Plan &plan,
+                                Context &ctx)
+   {
+      // Initialise problem with initial and goal states.
+      BidirectionalProblem<WS, H> prob(heuristic);
+      if(!BidirectionalAstarInit(init, goal, prob, ctx))
+         return false;
+
+      // Iterate.
+      while(BidirectionalAstarIteration(prob, actions, objects, ctx)) {}
+
+      // Finalise and return success.
+      BidirectionalAstarFinalise(prob, plan, ctx);
+      return prob.success;
+   }
+
+   /// Perform a complete bidirectional A* search guided by the number of
+   /// predicates that differ from each search's target.
+   /// @see BidirectionalAstarSolve
+   /// @ingroup Aesop
+   template < class WS, class AS >
+   bool BidirectionalAstarSolve(const WS &init, const WS &goal,
+                                const AS &actions,
+                                const Objects &objects,
+                                Plan &plan,
+                                Context &ctx)
+   {
+      return BidirectionalAstarSolve(init, goal, actions, objects, GoalCountHeuristic(), plan, ctx);
+   }
+};
+
+#endif
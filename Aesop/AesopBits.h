@@ -0,0 +1,124 @@
+/// @file AesopBits.h
+/// Helpers for packed bitset storage of predicate values.
+
+#ifndef _AE_BITS_H_
+#define _AE_BITS_H_
+
+#include <stdint.h>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Aesop {
+   /// Word type that predicate values are packed into.
+   /// @ingroup Aesop
+   typedef uint64_t bitword;
+
+   /// Number of predicate values stored in each word.
+   /// @ingroup Aesop
+   const unsigned int wordBits = 64;
+
+   /// Number of words needed to store some bits.
+   /// @param[in] bits Number of bits to store.
+   /// @ingroup Aesop
+   inline unsigned int wordCount(unsigned int bits)
+   { return (bits + wordBits - 1) / wordBits; }
+
+   /// Word that holds a given bit.
+   /// @ingroup Aesop
+   inline unsigned int wordIndex(unsigned int bit)
+   { return bit / wordBits; }
+
+   /// Mask that selects a given bit within its word.
+   /// @ingroup Aesop
+   inline bitword bitMask(unsigned int bit)
+   { return (bitword)1 << (bit % wordBits); }
+
+   /// Count the bits set in a word.
+   /// @ingroup Aesop
+   inline unsigned int popcount(bitword w)
+   {
+#if defined(__GNUC__)
+      return __builtin_popcountll(w);
+#elif defined(_MSC_VER) && defined(_M_X64)
+      return (unsigned int)__popcnt64(w);
+#else
+      w = w - ((w >> 1) & 0x5555555555555555ULL);
+      w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+      w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+      return (unsigned int)((w * 0x0101010101010101ULL) >> 56);
+#endif
+   }
+
+   /// Find the lowest bit set in a word.
+   /// @param[in] w Word to search. Must not be zero.
+   /// @return Position of the lowest set bit.
+   /// @ingroup Aesop
+   inline unsigned int lowestBit(bitword w)
+   {
+#if defined(__GNUC__)
+      return __builtin_ctzll(w);
+#else
+      return popcount((w & (~w + 1)) - 1);
+#endif
+   }
+
+   /// Find the next bit set in a packed bitmap.
+   /// @param[in] bits Bitmap to search.
+   /// @param[in] from First bit to consider.
+   /// @return Position of the first set bit at or after from, or a position
+   ///         past the end of the bitmap if there are none.
+   /// @ingroup Aesop
+   inline unsigned int nextBit(const std::vector<bitword> &bits, unsigned int from)
+   {
+      unsigned int w = wordIndex(from);
+      if(w >= bits.size())
+         return bits.size() * wordBits;
+      bitword word = bits[w] & (~(bitword)0 << (from % wordBits));
+      while(!word)
+      {
+         if(++w == bits.size())
+            return bits.size() * wordBits;
+         word = bits[w];
+      }
+      return w * wordBits + lowestBit(word);
+   }
+
+   /// Hash value of a WorldState.
+   /// @ingroup Aesop
+   typedef uint64_t statehash;
+
+   /// Get the Zobrist key of a predicate having a value. A state's hash is
+   /// the XOR of the keys of every predicate value it holds, so changing a
+   /// predicate only takes the keys of its old and new values. Keys are
+   /// generated from the predicate and value rather than stored in a table,
+   /// so every state type and every Predicates object agrees on them.
+   /// @param[in] pred  Predicate ID.
+   /// @param[in] value Value of the predicate.
+   /// @return Pseudo-random key, unique to the predicate and value.
+   /// @ingroup Aesop
+   inline statehash zobristKey(unsigned int pred, unsigned int value)
+   {
+      // The splitmix64 generator's output function.
+      statehash k = ((statehash)pred << 32 | value) * 0x9e3779b97f4a7c15ULL;
+      k = (k ^ (k >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      k = (k ^ (k >> 27)) * 0x94d049bb133111ebULL;
+      return k ^ (k >> 31);
+   }
+
+   /// Get the XOR of the Zobrist keys of the bits set in a packed word.
+   /// @param[in] word  Index of the word.
+   /// @param[in] bits  Predicates in the word to include.
+   /// @param[in] value Value the predicates have.
+   /// @ingroup Aesop
+   inline statehash zobristBits(unsigned int word, bitword bits, unsigned int value)
+   {
+      statehash h = 0;
+      for(; bits; bits &= bits - 1)
+         h ^= zobristKey(word * wordBits + lowestBit(bits), value);
+      return h;
+   }
+};
+
+#endif
@@ -0,0 +1,76 @@
+/// @file AesopBudget.h
+/// Definition of Budget class and time-sliced iteration.
+
+#ifndef _AE_BUDGET_H_
+#define _AE_BUDGET_H_
+
+#include <chrono>
+#include "abstract/AesopActionSet.h"
+#include "abstract/AesopObjects.h"
+#include "abstract/AesopContext.h"
+
+namespace Aesop {
+   /// Result of a time-sliced planning step.
+   /// @ingroup Aesop
+   enum SearchStatus {
+      /// A plan was found; the problem is ready to be finalised.
+      SearchSolved,
+      /// No plan exists; the problem is ready to be finalised.
+      SearchFailed,
+      /// The budget ran out before the search finished.
+      SearchInProgress
+   };
+
+   /// Limits on the work done by a single time-sliced planning step.
+   /// @ingroup Aesop
+   struct Budget {
+      /// Maximum number of iterations to perform, or 0 for no limit.
+      unsigned int iterations;
+      /// Maximum wall-clock time to spend in microseconds, or 0 for no
+      ///        limit. Checked after every iteration, so a step may overrun
+      ///        by the length of one iteration.
+      unsigned int microseconds;
+
+      /// Default constructor.
+      /// @param[in] iters Maximum number of iterations.
+      /// @param[in] us    Maximum time in microseconds.
+      Budget(unsigned int iters = 0, unsigned int us = 0)
+         : iterations(iters), microseconds(us) {}
+   };
+
+   /// Run iterations of a search algorithm until it finishes or its budget
+   /// runs out.
+   /// @param     iteration Iteration function of the algorithm to run.
+   /// @param     prob      Problem to operate on.
+   /// @param[in] actions   Set of actions to operate with.
+   /// @param[in] objects   Set of objects that exist in the problem.
+   /// @param[in] budget    Limits on the work done by this step.
+   /// @param[out] ctx      Context for logging and profiling.
+   /// @return Status of the search after this step.
+   /// @ingroup Aesop
+   template < class P, class AS >
+   SearchStatus BudgetedStep(bool (*iteration)(P&, const AS&, const Objects&, Context&),
+                             P &prob,
+                             const AS &actions,
+                             const Objects &objects,
+                             const Budget &budget,
+                             Context &ctx)
+   {
+      typedef std::chrono::steady_clock clock;
+      clock::time_point deadline = clock::now() + std::chrono::microseconds(budget.microseconds);
+      unsigned int iters = 0;
+      while(true)
+      {
+         if(!iteration(prob, actions, objects, ctx))
+            return prob.success ? SearchSolved : SearchFailed;
+         iters++;
+         if(budget.iterations && iters >= budget.iterations)
+            break;
+         if(budget.microseconds && clock::now() >= deadline)
+            break;
+      }
+      return SearchInProgress;
+   }
+};
+
+#endif
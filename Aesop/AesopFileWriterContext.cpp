@@ -11,6 +11,7 @@ namespace Aesop {
    {
       mPlanStart = clock_t();
       mIters = 0;
+      mForgotten = 0;
    }
 
    void FileWriterContext::success()
@@ -27,6 +28,11 @@ namespace Aesop {
    {
    }
 
+   void FileWriterContext::forgotten(unsigned int ID)
+   {
+      mForgotten++;
+   }
+
    //void FileWriterContext::newState(const Problem::openstate &s)
    //{
    //}
@@ -34,6 +40,8 @@ namespace Aesop {
    void FileWriterContext::beginPlanning()
    {
       mPlanStart = clock();
+      mIters = 0;
+      mForgotten = 0;
    }
 
    void FileWriterContext::beginIteration()
@@ -50,5 +58,7 @@ namespace Aesop {
       float planTime = (clock() - mPlanStart) / CLOCKS_PER_SEC * 1000.0f;
       fprintf(&mFile, "Planning finished in %.3fms after %d iterations.\n",
          planTime, mIters);
+      if(mForgotten)
+         fprintf(&mFile, "%d states were forgotten to save memory.\n", mForgotten);
    }
 };
@@ -18,6 +18,7 @@ namespace Aesop {
       virtual void success();
       virtual void failure();
       virtual void toClosed(unsigned int ID);
+      virtual void forgotten(unsigned int ID);
       //virtual void newState(const Problem::openstate &s);
       virtual void beginPlanning();
       virtual void beginIteration();
@@ -39,6 +40,9 @@ namespace Aesop {
 
       /// Number of iterations performed.
       unsigned int mIters;
+
+      /// Number of states forgotten by memory-bounded searches.
+      unsigned int mForgotten;
    };
 };
 
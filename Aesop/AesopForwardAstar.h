@@ -1,26 +1,29 @@
-/// @file AesopReverseAstar.h
-/// @brief Implementation of regressive A* search algorithm.
+/// @file AesopForwardAstar.h
+/// Implementation of progressive A* search algorithm.
 
-#ifndef _AE_REVERSE_ASTAR_H_
-#define _AE_REVERSE_ASTAR_H_
+#ifndef _AE_FORWARD_ASTAR_H_
+#define _AE_FORWARD_ASTAR_H_
 
-#include <algorithm>
-#include <functional>
-#include "AesopWorldState.h"
-#include "AesopActionSet.h"
-#include "AesopObjects.h"
+#include <vector>
+#include "abstract/AesopWorldState.h"
+#include "abstract/AesopActionSet.h"
+#include "abstract/AesopObjects.h"
 #include "AesopProblem.h"
 #include "AesopPlan.h"
-#include "AesopContext.h"
+#include "abstract/AesopContext.h"
+#include "AesopBudget.h"
 
 namespace Aesop {
-   /// @brief Initialise a regressive A* solution.
+   /// Set up a Problem for a progressive A* search, without telling a Context
+   ///        that planning has begun. Searches built out of this one use it
+   ///        so that planning only begins once.
    /// @param[in]  init Initial world state for this problem.
    /// @param[in]  goal Desired world state for this problem.
    /// @param[out] prob Problem object to initialise.
-   /// @param[out] ctx  Context for logging and profiling.
    /// @return True if initialisation was successful, false if not.
-   bool ReverseAstarInit(const WorldState &init, const WorldState &goal, Problem &prob, Context &ctx = NullContext())
+   /// @ingroup Aesop
+   template < class WS, class H >
+   bool ForwardAstarStart(const WS &init, const WS &goal, Problem<WS, H> &prob)
    {
       // Check that the predicates used by each state match.
       if(init.getPredicates() != goal.getPredicates())
@@ -28,26 +31,41 @@ namespace Aesop {
          //ctx.
          return false;
       }
-      ctx.beginPlanning();
-      // Goal is actually initial state since we're doing a regressive search.
-      prob.goal = &init;
+      prob.goal = &goal;
       // Clear problem data.
-      prob.open.clear();
-      prob.closed.clear();
-      prob.success = false;
+      prob.reset();
       // Push the first state onto the open list.
-      prob.open.push_back(Problem::openstate());
-      prob.open.back().state = goal.clone();
+      typename Problem<WS, H>::openstate s;
+      s.state = prob.store(init);
+      prob.push(s);
+      return true;
+   }
+
+   /// Initialise a progressive A* solution.
+   /// @param[in]  init Initial world state for this problem.
+   /// @param[in]  goal Desired world state for this problem.
+   /// @param[out] prob Problem object to initialise.
+   /// @param[out] ctx  Context for logging and profiling.
+   /// @return True if initialisation was successful, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   bool ForwardAstarInit(const WS &init, const WS &goal, Problem<WS, H> &prob, Context &ctx)
+   {
+      if(!ForwardAstarStart(init, goal, prob))
+         return false;
+      ctx.beginPlanning();
       return true;
    }
 
-   /// @brief Perform a single iteration in a regressive A* search.
+   /// Perform a single iteration in a progressive A* search.
    /// @param     prob    Problem to operate on.
    /// @param[in] actions Set of actions to operate with.
-   /// @param[un] objects Set of objects that exist in the problem.
+   /// @param[in] objects Set of objects that exist in the problem.
    /// @param[out] ctx    Context for logging and profiling.
    /// @return True if the algorithm should continue, false if not.
-   bool ReverseAstarIteration(Problem &prob, const ActionSet &actions, const Objects &objects, Context &ctx = NullContext())
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool ForwardAstarIteration(Problem<WS, H> &prob, const AS &actions, const Objects &objects, Context &ctx)
    {
       ctx.beginIteration();
 
@@ -58,14 +76,13 @@ namespace Aesop {
          return false;
       }
 
-      pop_heap(prob.open.begin(), prob.open.end(), std::greater<Problem::openstate>());
-      Problem::openstate s = prob.open.back();
-      prob.open.pop_back();
+      unsigned int id = prob.pop();
+      const typename Problem<WS, H>::openstate &s = prob.nodes[id];
 
       ctx.toClosed(s.ID);
-      prob.closed.push_back(s);
+      prob.close(id);
 
-      if(*s.state == *prob.goal)
+      if(ReachedGoal(*s.state, *prob.goal))
       {
          ctx.success();
          ctx.endIteration();
@@ -73,71 +90,68 @@ namespace Aesop {
          return false;
       }
 
+      // Ask the heuristic which actions are best to take from here.
+      bool prefer = HelpfulActions(prob.heuristic, *s.state, *prob.goal, false, prob.helpful);
+
+      // Find the actions that can be performed here.
+      bool exact = GetApplicable(actions, *s.state, false, prob.applicable);
+
+      // Successors are generated in place, in the scratch state.
+      WS &next = prob.scratch.begin(*s.state);
+
       // For each action we can take
+      ActionSet::paramcombos &plist = prob.combos;
+      const ActionSet::const_iterator last = ActionsEnd(actions);
       ActionSet::const_iterator it;
-      for(it = actions.begin(); it != actions.end(); it++)
+      for(it = nextBit(prob.applicable, ActionsBegin(actions)); it < last; it = nextBit(prob.applicable, it + 1))
       {
          // Get list of parameter combinations.
-         ActionSet::paramcombos plist;
-         actions.getParamList(it, plist, objects);
+         plist.clear();
+         GetParamList(actions, it, plist, objects);
          ActionSet::paramcombos::const_iterator p;
          // For each valid parameter combination:
          for(p = plist.begin(); p != plist.end(); p++)
          {
-            // If the action doesn't post-match this world state, continue.
-            if(!actions.postMatch(it, *p, *s.state))
+            // If the action can't be performed in this world state, continue.
+            if(!exact && !PreMatch(actions, it, *p, *s.state))
                continue;
-            // Create a new world state by applying the action in reverse.
-            Problem::openstate n;
-            n.ID = prob.lastID++;
-            n.state = s.state->clone();
-            actions.applyReverse(it, *p, *n.state);
+            // Create a new world state by applying the action.
+            ApplyForwardScratch(actions, it, *p, prob.scratch);
+            typename Problem<WS, H>::openstate n;
             n.action = it;
             n.params = *p;
-            ctx.newState(n);
+            n.preferred = prefer && prob.helpful[it];
+            //ctx.newState(n);
             // If the new state is already in the closed list, continue.
-            Problem::list::const_iterator cli;
-            for(cli = prob.closed.begin(); cli != prob.closed.end(); cli++)
+            if(prob.findClosed(next) != HashIndex::None)
             {
-               if(*n.state == *cli->state)
-               {
-                  //ctx.
-                  delete n.state;
-                  break;
-               }
-            }
-            if(cli != prob.closed.end())
+               //ctx.
+               prob.scratch.undo();
                continue;
+            }
             // Parent is last item in closed list.
             n.parent = prob.closed.size() - 1;
             // Calculate cost.
-            n.G = s.G + 1;
-            n.H = (float)s.state->compare(*prob.goal);
+            n.G = s.G + ActionCost(actions, it, *p, *s.state);
+            n.H = prob.heuristic(next, *prob.goal);
             n.cost = n.G + n.H;
             // Check whether state is already in the open list; if so, we may
             // update its cost.
-            Problem::list::iterator oli;
-            // Check to see if the world state is already in the open list.
-            for(oli = prob.open.begin(); oli != prob.open.end(); oli++)
+            unsigned int oi = prob.findOpen(next);
+            if(oi == HashIndex::None)
             {
-               if(*n.state == *oli->state && n < *oli)
-               {
-                  //ctx.
-                  // We've found a more efficient way of getting here.
-                  *oli = n;
-                  // Reorder the heap.
-                  make_heap(prob.open.begin(), prob.open.end(),
-                     std::greater<Problem::openstate>());
-                  break;
-               }
+               //ctx.
+               // Only now does the state need storage of its own.
+               n.state = prob.store(next);
+               prob.push(n);
             }
-            // Push onto the open list if not already in it.
-            if(oli == prob.open.end())
+            else
             {
-               //ctx.
-               prob.open.push_back(n);
-               push_heap(prob.open.begin(), prob.open.end(), std::greater<Problem::openstate>());
+               // We've found a more efficient way of getting here.
+               if(n < prob.nodes[prob.open[oi]])
+                  prob.improve(oi, n);
             }
+            prob.scratch.undo();
          }
       }
 
@@ -145,52 +159,90 @@ namespace Aesop {
       return true;
    }
 
-   /// @brief Finalise a completed Problem into a Plan.
+   /// Perform as many iterations of a progressive A* search as a budget allows.
+   /// @param     prob    Problem to operate on.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @param[in] budget  Limits on the work done by this step.
+   /// @param[out] ctx    Context for logging and profiling.
+   /// @return Status of the search after this step. Once the search is no
+   ///         longer in progress, the problem should be finalised.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   SearchStatus ForwardAstarStep(Problem<WS, H> &prob, const AS &actions, const Objects &objects, const Budget &budget, Context &ctx)
+   {
+      return BudgetedStep(ForwardAstarIteration<WS, H, AS>, prob, actions, objects, budget, ctx);
+   }
+
+   /// Finalise a completed Problem into a Plan.
    /// @param[in]  prob Problem to operate on.
    /// @param[out] plan Plan to operate on.
    /// @param[out] ctx  Context for logging and profiling.
-   void ReverseAstarFinalise(const Problem &prob, Plan &plan, Context &ctx = NullContext())
+   /// @ingroup Aesop
+   template < class WS, class H >
+   void ForwardAstarFinalise(const Problem<WS, H> &prob, Plan &plan, Context &ctx)
    {
       if(prob.success)
       {
+         // Following parents leads us back to the initial state, so the
+         // steps are found last first, and put in order afterwards.
+         unsigned int first = plan.size();
          unsigned int i = prob.closed.size() - 1;
          while(i)
          {
-            // Extract the action performed at this step and its parameters.
-            plan.push(prob.closed[i].action, prob.closed[i].params);
-            // Iterate.
-            i = prob.closed[i].parent;
+            const typename Problem<WS, H>::openstate &n = prob.nodes[prob.closed[i]];
+            plan.push(n.action, n.params);
+            i = n.parent;
          }
+         plan.reverse(first);
       }
       ctx.endPlanning();
    }
 
-   /// @brief Perform a complete regressive A* search.
-   /// @param[in]  init    Initial world state.
-   /// @param[in]  goal    Desired world state.
-   /// @param[in]  actions Set of actions to operate with.
-   /// @param[in]  objects Set of objects that exist in the problem.
-   /// @param[out] plan    Plan output.
-   /// @param[out] ctx     Context for logging and profiling.
+   /// Perform a complete progressive A* search.
+   /// @param[in]  init      Initial world state.
+   /// @param[in]  goal      Desired world state.
+   /// @param[in]  actions   Set of actions to operate with.
+   /// @param[in]  objects   Set of objects that exist in the problem.
+   /// @param[in]  heuristic Heuristic to guide the search with.
+   /// @param[out] plan      Plan output.
+   /// @param[out] ctx       Context for logging and profiling.
    /// @return True if a valid plan was found, false if not.
-   bool ReverseAstarSolve(const WorldState &init, const WorldState &goal,
-                          const ActionSet &actions,
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool ForwardAstarSolve(const WS &init, const WS &goal,
+                          const AS &actions,
                           const Objects &objects,
+                          const H &heuristic,
                           Plan &plan,
-                          Context &ctx = NullContext())
+                          Context &ctx)
    {
-      // Initialise problem with initial and goal states.
-      Problem prob;
-      if(!ReverseAstarInit(init, goal, prob, ctx))
+      // Initialise this thread's workspace with initial and goal states.
+      Problem<WS, H> &prob = ThreadProblem<WS>(heuristic);
+      if(!ForwardAstarInit(init, goal, prob, ctx))
          return false;
 
       // Iterate.
-      while(ReverseAstarIteration(prob, actions, objects, ctx)) {}
+      while(ForwardAstarIteration(prob, actions, objects, ctx)) {}
 
       // Finalise and return success.
-      ReverseAstarFinalise(prob, plan, ctx);
+      ForwardAstarFinalise(prob, plan, ctx);
       return prob.success;
    }
+
+   /// Perform a complete progressive A* search, guided by the number of
+   /// predicates that differ from the goal state.
+   /// @see ForwardAstarSolve
+   /// @ingroup Aesop
+   template < class WS, class AS >
+   bool ForwardAstarSolve(const WS &init, const WS &goal,
+                          const AS &actions,
+                          const Objects &objects,
+                          Plan &plan,
+                          Context &ctx)
+   {
+      return ForwardAstarSolve(init, goal, actions, objects, GoalCountHeuristic(), plan, ctx);
+   }
 };
 
 #endif
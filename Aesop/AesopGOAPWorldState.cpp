@@ -3,22 +3,14 @@
 
 #include "AesopGOAPWorldState.h"
 
-// From http://www.programmersheaven.com/mb/CandCPP/79561/79561/bitwise-rotation/
-static unsigned int ror32(unsigned int data, unsigned int bits) {
-  return (data >> bits) | (data << (32-bits));
-}
-static unsigned int rol32(unsigned int data, unsigned int bits) {
-  return (data << bits) | (data >> (32-bits));
-}
-
 namespace Aesop {
    /// @class GOAPWorldState
    ///
-   /// This WorldState allows a single parameter per predicate.
+   /// This WorldState allows a single parameter per predicate. Its hash is
+   /// the XOR of the Zobrist keys of each predicate and its parameter.
 
    GOAPWorldState::GOAPWorldState(const Predicates &p) : WorldState(p)
    {
-      mHash = 0;
    }
 
    GOAPWorldState::~GOAPWorldState()
@@ -36,29 +28,39 @@ namespace Aesop {
    void GOAPWorldState::set(Predicates::predID pred, const paramlist &params)
    {
       if(params.size())
-      {
          _set(pred, params[0]);
-         updateHash();
-      }
    }
 
    void GOAPWorldState::_set(Predicates::predID pred, Objects::objectID param)
    {
-      mWorld[pred] = param;
+      std::pair<worldrep::iterator, bool> ins = mWorld.insert(worldrep::value_type(pred, param));
+      if(!ins.second)
+      {
+         mHash ^= zobristKey(pred, ins.first->second);
+         ins.first->second = param;
+      }
+      mHash ^= zobristKey(pred, param);
    }
 
    void GOAPWorldState::unset(Predicates::predID pred, const paramlist &params)
    {
       if(params.size())
-      {
          _unset(pred, params[0]);
-         updateHash();
-      }
    }
 
    void GOAPWorldState::_unset(Predicates::predID pred, Objects::objectID param)
    {
-      mWorld.erase(pred);
+      worldrep::iterator it = mWorld.find(pred);
+      if(it != mWorld.end())
+      {
+         mHash ^= zobristKey(pred, it->second);
+         mWorld.erase(it);
+      }
+   }
+
+   WorldState *GOAPWorldState::clone() const
+   {
+      return new GOAPWorldState(*this);
    }
 
    std::string GOAPWorldState::repr() const
@@ -72,8 +74,4 @@ namespace Aesop {
    {
       return mWorld == other.mWorld ? 0 : 1;
    }
-
-   void GOAPWorldState::updateHash()
-   {
-   }
 };
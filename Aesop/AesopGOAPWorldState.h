@@ -21,11 +21,12 @@ namespace Aesop {
       { return !isSet(pred, params); }
       virtual void set(Predicates::predID pred, const paramlist &params = paramlist());
       virtual void unset(Predicates::predID pred, const paramlist &params = paramlist());
+      virtual WorldState *clone() const;
       virtual std::string repr() const;
 
       /// @}
 
-      void set(Predicates::predID pred, Objects::objectID param) { _set(pred, param); updateHash(); }
+      void set(Predicates::predID pred, Objects::objectID param) { _set(pred, param); }
 
       /// @name Comparisons
       /// @{
@@ -51,18 +52,14 @@ namespace Aesop {
 
    protected:
    private:
-      /// Set a predicate without updating our hash.
+      /// Set a predicate's parameter, updating our hash with the keys of
+      ///        its old and new values.
       /// @see WorldState::set
       void _set(Predicates::predID pred, Objects::objectID param);
-      /// Unset a predicate without updating our hash.
+      /// Unset a predicate, removing its value's key from our hash.
       /// @see WorldState::unset
       void _unset(Predicates::predID pred, Objects::objectID param);
 
-      /// Hashed representation of this state, used for quick comparison.
-      int mHash;
-      /// Update our hash value.
-      void updateHash();
-
       /// World representation.
       typedef std::map<Predicates::predID, Objects::objectID> worldrep;
       /// Store world state.
@@ -0,0 +1,124 @@
+/// @file AesopHashIndex.cpp
+/// Implementation of HashIndex class as defined in AesopHashIndex.h
+
+#include "AesopHashIndex.h"
+
+namespace Aesop {
+   /// @class HashIndex
+   ///
+   /// Slots are probed linearly from the entry's home slot. Deleting an entry
+   /// shifts later entries of the same probe run back into the gap, so the
+   /// table never needs tombstones and lookups stay short. The table doubles
+   /// in size whenever it becomes half full. Slots are stamped with the
+   /// generation they were filled in, so clearing the table only needs to
+   /// start a new generation.
+
+   const unsigned int HashIndex::None = -1;
+
+   HashIndex::HashIndex()
+   {
+      mSize = 0;
+      mGeneration = 1;
+   }
+
+   unsigned int HashIndex::home(statehash hash) const
+   {
+      // Mix the bits so that similar hashes don't cluster together. This is
+      // the finaliser from MurmurHash3's 64-bit variant.
+      hash ^= hash >> 33;
+      hash *= 0xff51afd7ed558ccdULL;
+      hash ^= hash >> 33;
+      hash *= 0xc4ceb9fe1a85ec53ULL;
+      hash ^= hash >> 33;
+      return (unsigned int)hash & (mTable.size() - 1);
+   }
+
+   unsigned int HashIndex::find(statehash hash, unsigned int &slot) const
+   {
+      if(mTable.empty())
+         return None;
+      unsigned int mask = mTable.size() - 1;
+      slot = slot == None ? home(hash) : (slot + 1) & mask;
+      // Walk the probe run until we hit an empty slot.
+      while(occupied(slot))
+      {
+         if(mTable[slot].hash == hash)
+            return mTable[slot].index;
+         slot = (slot + 1) & mask;
+      }
+      return None;
+   }
+
+   void HashIndex::insert(statehash hash, unsigned int index)
+   {
+      if((mSize + 1) * 2 > mTable.size())
+         grow();
+      unsigned int mask = mTable.size() - 1;
+      unsigned int slot = home(hash);
+      while(occupied(slot))
+         slot = (slot + 1) & mask;
+      mTable[slot].hash = hash;
+      mTable[slot].index = index;
+      mTable[slot].generation = mGeneration;
+      mSize++;
+   }
+
+   bool HashIndex::erase(statehash hash, unsigned int index)
+   {
+      if(mTable.empty())
+         return false;
+      unsigned int mask = mTable.size() - 1;
+      unsigned int slot = home(hash);
+      while(occupied(slot) &&
+            (mTable[slot].hash != hash || mTable[slot].index != index))
+         slot = (slot + 1) & mask;
+      if(!occupied(slot))
+         return false;
+      // Shift following entries back to fill the gap, as long as doing so
+      // doesn't move them in front of their home slot.
+      unsigned int gap = slot;
+      slot = (slot + 1) & mask;
+      while(occupied(slot))
+      {
+         unsigned int h = home(mTable[slot].hash);
+         if(((slot - h) & mask) >= ((slot - gap) & mask))
+         {
+            mTable[gap] = mTable[slot];
+            gap = slot;
+         }
+         slot = (slot + 1) & mask;
+      }
+      mTable[gap] = entry();
+      mSize--;
+      return true;
+   }
+
+   void HashIndex::clear()
+   {
+      mSize = 0;
+      // Slots of every earlier generation are now empty. Generation 0 marks
+      // slots that were never filled, so if the counter wraps round, empty
+      // the table the slow way.
+      if(++mGeneration == 0)
+      {
+         entries::iterator it;
+         for(it = mTable.begin(); it != mTable.end(); it++)
+            *it = entry();
+         mGeneration = 1;
+      }
+   }
+
+   void HashIndex::grow()
+   {
+      entries old;
+      old.swap(mTable);
+      mTable.resize(old.empty() ? 16 : old.size() * 2);
+      mSize = 0;
+      entries::const_iterator it;
+      for(it = old.begin(); it != old.end(); it++)
+      {
+         if(it->generation == mGeneration)
+            insert(it->hash, it->index);
+      }
+   }
+};
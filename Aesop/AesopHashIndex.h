@@ -0,0 +1,87 @@
+/// @file AesopHashIndex.h
+/// Definition of HashIndex class.
+
+#ifndef _AE_HASHINDEX_H_
+#define _AE_HASHINDEX_H_
+
+#include <vector>
+#include "AesopBits.h"
+
+namespace Aesop {
+   /// Open-addressed hash table that maps state hashes to list indices.
+   ///
+   /// The table does not store states itself, only their hash values and an
+   /// index into some other list. Several entries may share a hash value, so
+   /// a lookup yields every candidate index in turn and the caller decides
+   /// which one (if any) actually matches.
+   ///
+   /// @ingroup Aesop
+   class HashIndex {
+   public:
+      /// Index value that represents the absence of an entry.
+      static const unsigned int None;
+
+      /// Find the next entry stored with a given hash.
+      /// @param[in]     hash Hash value to look for.
+      /// @param[in,out] slot Slot to continue searching from. Must be set to
+      ///                     None to begin a new search.
+      /// @return Index stored in the next entry with the given hash, or None
+      ///         if there are no more such entries.
+      unsigned int find(statehash hash, unsigned int &slot) const;
+
+      /// Add an entry to the table.
+      /// @param[in] hash  Hash value of the entry.
+      /// @param[in] index Index to associate with the hash.
+      void insert(statehash hash, unsigned int index);
+
+      /// Remove an entry from the table.
+      /// @param[in] hash  Hash value the entry was inserted with.
+      /// @param[in] index Index the entry was inserted with.
+      /// @return True iff the entry was found and removed.
+      bool erase(statehash hash, unsigned int index);
+
+      /// Remove all entries in constant time, keeping the table's size.
+      void clear();
+
+      /// Number of entries stored.
+      unsigned int size() const { return mSize; }
+
+      /// Default constructor.
+      HashIndex();
+
+   protected:
+   private:
+      /// A single slot in the table.
+      struct entry {
+         /// Full hash value of this entry.
+         statehash hash;
+         /// Index associated with the hash.
+         unsigned int index;
+         /// The slot is only occupied if this matches the table's
+         ///        generation.
+         unsigned int generation;
+         entry() : hash(0), index(None), generation(0) {}
+      };
+
+      /// Store slots in a vector whose size is a power of two.
+      typedef std::vector<entry> entries;
+      /// All slots in the table.
+      entries mTable;
+      /// Number of occupied slots.
+      unsigned int mSize;
+      /// Current generation of the table. Clearing the table starts a new
+      ///        generation, which empties every slot at once.
+      unsigned int mGeneration;
+
+      /// Is a slot occupied?
+      bool occupied(unsigned int slot) const
+      { return mTable[slot].generation == mGeneration; }
+
+      /// Get the first slot an entry with the given hash may occupy.
+      unsigned int home(statehash hash) const;
+      /// Double the size of the table and reinsert all entries.
+      void grow();
+   };
+};
+
+#endif
@@ -0,0 +1,159 @@
+/// @file AesopHeuristics.cpp
+/// Implementation of heuristic policies as defined in AesopHeuristics.h
+
+#include <limits>
+#include "AesopHeuristics.h"
+#include "AesopHashIndex.h"
+
+namespace Aesop {
+   const float RelaxedHeuristic::unreachable = std::numeric_limits<float>::max();
+
+   RelaxedHeuristic::RelaxedHeuristic(const SimpleActionSet &actions, bool additive)
+   {
+      mActions = &actions;
+      mAdditive = additive;
+      SimpleActionSet::const_iterator it;
+      for(it = actions.begin(); it != actions.end(); it++)
+      {
+         mRelaxed.push_back(action());
+         action &a = mRelaxed.back();
+         a.ac = it;
+         SimpleActionSet::literals list;
+         SimpleActionSet::literals::const_iterator l;
+         actions.getConditions(it, list);
+         for(l = list.begin(); l != list.end(); l++)
+            a.conditions.push_back(literal(l->pred, l->set));
+         list.clear();
+         actions.getEffects(it, list);
+         for(l = list.begin(); l != list.end(); l++)
+            a.effects.push_back(literal(l->pred, l->set));
+      }
+   }
+
+   void RelaxedHeuristic::propagate(const WorldState &from)
+   {
+      unsigned int p;
+      mCost.assign(mFrom.size() * 2, unreachable);
+      mSupporter.assign(mFrom.size() * 2, HashIndex::None);
+      for(p = 0; p < mFrom.size(); p++)
+         mCost[literal(p, mFrom[p])] = 0.0f;
+      mActionCost.resize(mRelaxed.size());
+      for(p = 0; p < mRelaxed.size(); p++)
+         mActionCost[p] = mActions->cost(mRelaxed[p].ac, WorldState::paramlist(), from);
+      // Keep applying actions until no literal gets any cheaper. Costs only
+      // ever fall, so this terminates.
+      bool changed = true;
+      while(changed)
+      {
+         changed = false;
+         std::vector<action>::const_iterator a;
+         for(a = mRelaxed.begin(); a != mRelaxed.end(); a++)
+         {
+            float c = 0.0f;
+            std::vector<unsigned int>::const_iterator l;
+            for(l = a->conditions.begin(); l != a->conditions.end(); l++)
+            {
+               if(mCost[*l] == unreachable)
+                  break;
+               if(mAdditive)
+                  c += mCost[*l];
+               else if(mCost[*l] > c)
+                  c = mCost[*l];
+            }
+            if(l != a->conditions.end())
+               continue;
+            c += mActionCost[a - mRelaxed.begin()];
+            for(l = a->effects.begin(); l != a->effects.end(); l++)
+            {
+               if(c < mCost[*l])
+               {
+                  mCost[*l] = c;
+                  mSupporter[*l] = a - mRelaxed.begin();
+                  changed = true;
+               }
+            }
+         }
+      }
+   }
+
+   float RelaxedHeuristic::combine() const
+   {
+      float h = 0.0f;
+      std::vector<unsigned int>::const_iterator l;
+      for(l = mTo.begin(); l != mTo.end(); l++)
+      {
+         if(mCost[*l] == unreachable)
+            return unreachable;
+         if(mAdditive)
+            h += mCost[*l];
+         else if(mCost[*l] > h)
+            h = mCost[*l];
+      }
+      return h;
+   }
+
+   float FFHeuristic::extract()
+   {
+      mInPlan.assign(mRelaxed.size(), false);
+      mOpen.clear();
+      // Work back from the target literals, choosing the cheapest supporter
+      // of each literal that isn't already true.
+      std::vector<unsigned int>::const_iterator l;
+      for(l = mTo.begin(); l != mTo.end(); l++)
+      {
+         if(mCost[*l] == unreachable)
+            return unreachable;
+         // Literals reached only by free actions cost nothing, but still
+         // need their supporter in the plan.
+         if(mSupporter[*l] != HashIndex::None)
+            mOpen.push_back(*l);
+      }
+      float h = 0.0f;
+      while(!mOpen.empty())
+      {
+         unsigned int a = mSupporter[mOpen.back()];
+         mOpen.pop_back();
+         if(mInPlan[a])
+            continue;
+         mInPlan[a] = true;
+         h += mActionCost[a];
+         for(l = mRelaxed[a].conditions.begin(); l != mRelaxed[a].conditions.end(); l++)
+         {
+            if(mSupporter[*l] != HashIndex::None)
+               mOpen.push_back(*l);
+         }
+      }
+      return h;
+   }
+
+   void FFHeuristic::mark(bool last, std::vector<bool> &helpful) const
+   {
+      helpful.assign(mActions->size(), false);
+      unsigned int a;
+      if(last)
+      {
+         // Actions that reach a target literal directly.
+         std::vector<unsigned int>::const_iterator l;
+         for(l = mTo.begin(); l != mTo.end(); l++)
+         {
+            if(mSupporter[*l] != HashIndex::None)
+               helpful[mRelaxed[mSupporter[*l]].ac] = true;
+         }
+         return;
+      }
+      // Actions in the relaxed plan that can be performed straight away.
+      for(a = 0; a < mRelaxed.size(); a++)
+      {
+         if(!mInPlan[a])
+            continue;
+         std::vector<unsigned int>::const_iterator l;
+         for(l = mRelaxed[a].conditions.begin(); l != mRelaxed[a].conditions.end(); l++)
+         {
+            if(mSupporter[*l] != HashIndex::None)
+               break;
+         }
+         if(l == mRelaxed[a].conditions.end())
+            helpful[mRelaxed[a].ac] = true;
+      }
+   }
+};
@@ -0,0 +1,263 @@
+/// @file AesopHeuristics.h
+/// Definition of heuristic policies used by the search algorithms.
+///
+/// A heuristic is any copyable class with a method
+/// @code
+/// float operator()(const WS &from, const WS &to);
+/// @endcode
+/// that estimates the cost of a plan leading from one WorldState to another.
+/// Progressive searches ask for the cost from each new state to the goal,
+/// and regressive searches for the cost from the initial state to each new
+/// state. Solvers take the heuristic as a template parameter, so the call is
+/// resolved at compile time and can be inlined away entirely.
+
+#ifndef _AE_HEURISTICS_H_
+#define _AE_HEURISTICS_H_
+
+#include <vector>
+#include "abstract/AesopWorldState.h"
+#include "AesopSimpleActionSet.h"
+
+namespace Aesop {
+   /// Heuristic that estimates every cost as zero. Searches using it are
+   /// uniform-cost (Dijkstra) searches.
+   /// @ingroup Aesop
+   struct NullHeuristic {
+      template < class WS >
+      float operator()(const WS &from, const WS &to) const { return 0.0f; }
+   };
+
+   /// Heuristic that counts the predicates whose values differ between two
+   /// states. Only admissible if no action costs less than 1 or changes more
+   /// than one predicate.
+   /// @ingroup Aesop
+   struct GoalCountHeuristic {
+      template < class WS >
+      float operator()(const WS &from, const WS &to) const { return (float)from.compare(to); }
+   };
+
+   /// Heuristic computed by ignoring the effects of actions that unset a
+   /// predicate's current value.
+   ///
+   /// In this relaxed problem a predicate value, once reached, is never lost,
+   /// so the cheapest way of reaching each value can be found by simply
+   /// applying every action repeatedly. The estimate for a state is then
+   /// combined from the costs of its predicate values. Costs are cached for
+   /// the last state estimated from, so a regressive search, which always
+   /// estimates from the initial state, only does this work once.
+   ///
+   /// Works with any WorldState whose actions are given by a SimpleActionSet.
+   ///
+   /// @ingroup Aesop
+   class RelaxedHeuristic {
+   public:
+      /// Estimate the cost of reaching one state from another.
+      /// @param[in] from State the plan would start in.
+      /// @param[in] to   State the plan would have to reach.
+      /// @return Combined cost of all of the target state's predicate values,
+      ///         or the largest float value if any of them can't be reached.
+      template < class WS >
+      float operator()(const WS &from, const WS &to)
+      {
+         update(from);
+         target(to);
+         return combine();
+      }
+
+      /// Cost of a predicate value that can't be reached.
+      static const float unreachable;
+
+      /// Default constructor.
+      /// @param[in] actions  Actions available in the problem.
+      /// @param[in] additive Estimate the cost of a state by adding the costs
+      ///                     of its values, rather than taking the largest.
+      RelaxedHeuristic(const SimpleActionSet &actions, bool additive);
+
+   protected:
+      /// Compute the cost of every literal from a state, unless they were
+      ///        already computed from an equal state.
+      /// @param[in] from State the plan would start in.
+      template < class WS >
+      void update(const WS &from)
+      {
+         unsigned int p, n = from.getPredicates().size();
+         bool changed = mFrom.size() != n;
+         mFrom.resize(n);
+         for(p = 0; p < n; p++)
+         {
+            bool set = from.isSet(p, WorldState::paramlist());
+            if(mFrom[p] != set)
+            {
+               mFrom[p] = set;
+               changed = true;
+            }
+         }
+         if(changed)
+            propagate(from);
+      }
+
+      /// Store the literals of a state as the target of the estimate.
+      ///        Predicates that are neither set nor unset are left out.
+      /// @param[in] to State the plan would have to reach.
+      template < class WS >
+      void target(const WS &to)
+      {
+         mTo.clear();
+         for(unsigned int p = 0; p < mFrom.size(); p++)
+         {
+            if(to.isSet(p, WorldState::paramlist()))
+               mTo.push_back(literal(p, true));
+            else if(to.isUnset(p, WorldState::paramlist()))
+               mTo.push_back(literal(p, false));
+         }
+      }
+
+      /// Combine the costs of the target literals.
+      /// @return Estimated cost of reaching the target.
+      float combine() const;
+
+      /// Index of the literal for a predicate value.
+      static unsigned int literal(Predicates::predID pred, bool set)
+      { return pred * 2 + (set ? 1 : 0); }
+
+      /// An action's conditions and effects as literal indices.
+      struct action {
+         ActionSet::const_iterator ac;
+         std::vector<unsigned int> conditions;
+         std::vector<unsigned int> effects;
+      };
+
+      /// Actions to relax.
+      const SimpleActionSet *mActions;
+      /// Relaxed versions of each action.
+      std::vector<action> mRelaxed;
+      /// Add costs together instead of taking the largest?
+      bool mAdditive;
+      /// Predicate values of the state costs were last computed from.
+      std::vector<bool> mFrom;
+      /// Cheapest relaxed cost of reaching each literal.
+      std::vector<float> mCost;
+      /// Position in mRelaxed of the action that reaches each literal most
+      ///        cheaply, or HashIndex::None.
+      std::vector<unsigned int> mSupporter;
+      /// Cost of each relaxed action in the state costs were computed from.
+      std::vector<float> mActionCost;
+      /// Literals of the target state.
+      std::vector<unsigned int> mTo;
+
+      /// Compute the cost of every literal from the values in mFrom.
+      /// @param[in] from State the values were taken from, used to get
+      ///                 the cost of each action.
+      void propagate(const WorldState &from);
+   };
+
+   /// Estimates the cost of a state as the cost of its most expensive
+   /// predicate value in the relaxed problem. Admissible.
+   /// @ingroup Aesop
+   class MaxHeuristic : public RelaxedHeuristic {
+   public:
+      MaxHeuristic(const SimpleActionSet &actions) : RelaxedHeuristic(actions, false) {}
+   };
+
+   /// Estimates the cost of a state as the sum of the costs of its predicate
+   /// values in the relaxed problem. Usually far better informed than
+   /// MaxHeuristic, but not admissible.
+   /// @ingroup Aesop
+   class AddHeuristic : public RelaxedHeuristic {
+   public:
+      AddHeuristic(const SimpleActionSet &actions) : RelaxedHeuristic(actions, true) {}
+   };
+
+   /// Estimates the cost of a state as the cost of a plan that reaches it in
+   /// the relaxed problem (h_FF).
+   ///
+   /// The plan is found by working back from the target state, choosing the
+   /// cheapest way to reach each predicate value that AddHeuristic found,
+   /// and the estimate is the total cost of the distinct actions used. Unlike
+   /// AddHeuristic, an action that helps with several values is only counted
+   /// once. Not admissible.
+   ///
+   /// The actions in this relaxed plan are likely to be good choices in the
+   /// real problem too. Searches ask for them using HelpfulActions, and
+   /// prefer states reached through them.
+   ///
+   /// @ingroup Aesop
+   class FFHeuristic : public RelaxedHeuristic {
+   public:
+      /// Estimate the cost of reaching one state from another.
+      /// @param[in] from State the plan would start in.
+      /// @param[in] to   State the plan would have to reach.
+      /// @return Cost of the relaxed plan, or the largest float value if
+      ///         the target can't be reached.
+      template < class WS >
+      float operator()(const WS &from, const WS &to)
+      {
+         update(from);
+         target(to);
+         return extract();
+      }
+
+      /// Mark the actions of the relaxed plan between two states that are
+      ///        worth trying first.
+      /// @param[in]  from    State the plan would start in.
+      /// @param[in]  to      State the plan would have to reach.
+      /// @param[in]  last    Mark actions that could end the plan, for a
+      ///                     regressive search, rather than actions that
+      ///                     could start it.
+      /// @param[out] helpful Set to true for each helpful action, indexed
+      ///                     by ActionSet::const_iterator.
+      template < class WS >
+      void helpfulActions(const WS &from, const WS &to, bool last, std::vector<bool> &helpful)
+      {
+         update(from);
+         target(to);
+         extract();
+         mark(last, helpful);
+      }
+
+      FFHeuristic(const SimpleActionSet &actions) : RelaxedHeuristic(actions, true) {}
+
+   private:
+      /// Actions used by the last relaxed plan, by position in mRelaxed.
+      std::vector<bool> mInPlan;
+      /// Literals still to be reached while building the relaxed plan.
+      std::vector<unsigned int> mOpen;
+
+      /// Build a relaxed plan that reaches the target literals.
+      /// @return Total cost of the plan.
+      float extract();
+
+      /// Mark helpful actions of the last relaxed plan.
+      void mark(bool last, std::vector<bool> &helpful) const;
+   };
+
+   /// Mark the actions a heuristic considers worth trying first. Heuristics
+   /// don't have any such preference unless this function is overloaded for
+   /// them.
+   /// @param     h       Heuristic to ask.
+   /// @param[in] from    State the plan would start in.
+   /// @param[in] to      State the plan would have to reach.
+   /// @param[in] last    Mark actions that could end the plan rather than
+   ///                    start it.
+   /// @param[out] helpful Set to true for each helpful action.
+   /// @return True if the heuristic marked helpful actions, false if it has
+   ///         no preference.
+   /// @ingroup Aesop
+   template < class H, class WS >
+   bool HelpfulActions(H &h, const WS &from, const WS &to, bool last, std::vector<bool> &helpful)
+   {
+      return false;
+   }
+
+   /// FFHeuristic prefers the actions in its relaxed plan.
+   /// @see HelpfulActions
+   /// @ingroup Aesop
+   template < class WS >
+   bool HelpfulActions(FFHeuristic &h, const WS &from, const WS &to, bool last, std::vector<bool> &helpful)
+   {
+      h.helpfulActions(from, to, last, helpful);
+      return true;
+   }
+};
+
+#endif
@@ -0,0 +1,319 @@
+/// @file AesopIDAstar.h
+/// Implementation of regressive iterative-deepening A* search algorithm.
+
+#ifndef _AE_IDASTAR_H_
+#define _AE_IDASTAR_H_
+
+#include <vector>
+#include <limits>
+#include "abstract/AesopWorldState.h"
+#include "abstract/AesopActionSet.h"
+#include "abstract/AesopObjects.h"
+#include "AesopPlan.h"
+#include "AesopScratchState.h"
+#include "AesopHeuristics.h"
+#include "abstract/AesopContext.h"
+#include "AesopBudget.h"
+
+namespace Aesop {
+   /// Stores planner instance data used by the IDA* algorithm.
+   ///
+   /// Unlike Problem, nothing is stored about states that are not on the
+   /// path currently being explored, so memory use is linear in the depth of
+   /// the search. Even the states on the path aren't copied: the search
+   /// applies each action to a single working state and undoes it on the way
+   /// back, keeping only the actions taken and the hash of each state.
+   ///
+   /// @ingroup Aesop
+   template < class WS, class H = GoalCountHeuristic >
+   struct IDAProblem {
+      /// Was a plan successfully created?
+      bool success;
+
+      /// State this problem is trying to reach.
+      const WS *goal;
+
+      /// Maximum total cost of states expanded in the current iteration.
+      float bound;
+
+      /// State the search starts from.
+      const WS *start;
+
+      /// The state at the end of the current path. Actions are applied to
+      ///        it on the way down the path and undone on the way back.
+      ScratchState<WS> scratch;
+
+      /// Actions taken along the current path. Entry i leads from the
+      ///        state at depth i to the one at depth i+1.
+      std::vector<Plan::actionentry> steps;
+
+      /// Hash of each state on the current path, used to avoid cycles.
+      std::vector<statehash> hashes;
+
+      /// Holds a state on the path while it is rebuilt from the steps, to
+      ///        check that a state with the same hash really is the same.
+      std::vector<WS> probe;
+
+      /// Actions that match each state on the path, as returned by
+      ///        ActionSet::getApplicable. Entries beyond the current depth
+      ///        are kept to be reused by later paths, so deep searches stop
+      ///        allocating once they have been as deep before.
+      std::vector<std::vector<bitword> > applicable;
+
+      /// Parameter combinations of the action being tried at each depth,
+      ///        as returned by ActionSet::getParamList.
+      std::vector<ActionSet::paramcombos> combos;
+
+      /// Estimates the cost of reaching one state from another.
+      H heuristic;
+
+      /// Default constructor.
+      /// @param[in] h Heuristic to guide the search with.
+      IDAProblem(const H &h = H()) : success(false), goal(NULL), bound(0.0f), start(NULL), heuristic(h) {}
+   };
+
+   /// Initialise a regressive IDA* solution.
+   /// @param[in]  init Initial world state for this problem.
+   /// @param[in]  goal Desired world state for this problem.
+   /// @param[out] prob Problem object to initialise.
+   /// @param[out] ctx  Context for logging and profiling.
+   /// @return True if initialisation was successful, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   bool IDAstarInit(const WS &init, const WS &goal, IDAProblem<WS, H> &prob, Context &ctx)
+   {
+      // Check that the predicates used by each state match.
+      if(init.getPredicates() != goal.getPredicates())
+      {
+         //ctx.
+         return false;
+      }
+      ctx.beginPlanning();
+      // Goal is actually initial state since we're doing a regressive search.
+      prob.goal = &init;
+      prob.success = false;
+      prob.start = &goal;
+      prob.steps.clear();
+      prob.hashes.clear();
+      // First iteration will only expand states as good as the goal.
+      prob.bound = prob.heuristic(init, goal);
+      return true;
+   }
+
+   /// Is the working state of an IDAProblem already on the current path?
+   /// @param     prob    Problem to check.
+   /// @param[in] actions Set of actions the path was built with.
+   /// @return True iff a state on the path equals the working state.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool IDAstarOnPath(IDAProblem<WS, H> &prob, const AS &actions)
+   {
+      const WS &ws = prob.scratch.state();
+      for(unsigned int i = 0; i < prob.hashes.size(); i++)
+      {
+         if(prob.hashes[i] != ws.hash())
+            continue;
+         // Rebuild the state at this depth to be sure it matches.
+         if(prob.probe.empty())
+            prob.probe.push_back(*prob.start);
+         else
+            prob.probe[0] = *prob.start;
+         for(unsigned int s = 0; s < i; s++)
+            ApplyReverse(actions, prob.steps[s].action, prob.steps[s].parameters, prob.probe[0]);
+         if(prob.probe[0] == ws)
+            return true;
+      }
+      return false;
+   }
+
+   /// Explore the current path depth-first within the Problem's cost bound.
+   /// @param     prob    Problem to operate on. Its working state is the
+   ///                    state to explore from, and is left as it was.
+   /// @param[in] depth   Number of steps taken to reach that state.
+   /// @param[in] G       Cost accrued to reach that state.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @return The smallest total cost that exceeded the bound, or a
+   ///         negative value if the goal was reached.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   float IDAstarSearch(IDAProblem<WS, H> &prob, unsigned int depth, float G,
+                       const AS &actions, const Objects &objects)
+   {
+      WS &ws = prob.scratch.state();
+      float cost = G + prob.heuristic(*prob.goal, ws);
+      if(cost > prob.bound)
+         return cost;
+      if(ReachedGoal(*prob.goal, ws))
+         return -1.0f;
+
+      if(prob.applicable.size() <= depth)
+      {
+         prob.applicable.resize(depth + 1);
+         prob.combos.resize(depth + 1);
+      }
+      prob.hashes.push_back(ws.hash());
+
+      float next = std::numeric_limits<float>::max();
+      // Find the actions that could lead here. Deeper calls may move the
+      // per-depth buffers, so they are always found by index.
+      bool exact = GetApplicable(actions, ws, true, prob.applicable[depth]);
+
+      // For each action we can take
+      const ActionSet::const_iterator last = ActionsEnd(actions);
+      ActionSet::const_iterator it;
+      for(it = nextBit(prob.applicable[depth], ActionsBegin(actions)); it < last; it = nextBit(prob.applicable[depth], it + 1))
+      {
+         // Get list of parameter combinations.
+         prob.combos[depth].clear();
+         GetParamList(actions, it, prob.combos[depth], objects);
+         // For each valid parameter combination:
+         for(unsigned int k = 0; k < prob.combos[depth].size(); k++)
+         {
+            const WorldState::paramlist &params = prob.combos[depth][k];
+            // If the action doesn't post-match this world state, continue.
+            if(!exact && !PostMatch(actions, it, params, ws))
+               continue;
+            // Apply the action in reverse to the working state.
+            ApplyReverseScratch(actions, it, params, prob.scratch);
+            // Don't revisit states already on the current path.
+            if(IDAstarOnPath(prob, actions))
+            {
+               prob.scratch.undo();
+               continue;
+            }
+            prob.steps.push_back(Plan::actionentry(it, params));
+            float c = ActionCost(actions, it, params, ws);
+            float t = IDAstarSearch(prob, depth + 1, G + c, actions, objects);
+            // On success, leave the path as it is for finalising.
+            if(t < 0.0f)
+               return t;
+            prob.steps.pop_back();
+            prob.scratch.undo();
+            if(t < next)
+               next = t;
+         }
+      }
+      prob.hashes.pop_back();
+      return next;
+   }
+
+   /// Perform a single iteration in a regressive IDA* search. Each iteration
+   /// is a complete depth-first search within the current cost bound.
+   /// @param     prob    Problem to operate on.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @param[out] ctx    Context for logging and profiling.
+   /// @return True if the algorithm should continue, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool IDAstarIteration(IDAProblem<WS, H> &prob, const AS &actions, const Objects &objects, Context &ctx)
+   {
+      ctx.beginIteration();
+
+      prob.steps.clear();
+      prob.hashes.clear();
+      prob.scratch.begin(*prob.start);
+      float next = IDAstarSearch(prob, 0, 0.0f, actions, objects);
+      if(next < 0.0f)
+      {
+         ctx.success();
+         ctx.endIteration();
+         prob.success = true;
+         return false;
+      }
+      // Nothing exceeded the bound, so there is nowhere left to look.
+      if(next == std::numeric_limits<float>::max())
+      {
+         ctx.failure();
+         ctx.endIteration();
+         return false;
+      }
+      prob.bound = next;
+
+      ctx.endIteration();
+      return true;
+   }
+
+   /// Perform as many iterations of a regressive IDA* search as a budget
+   /// allows.
+   /// @param     prob    Problem to operate on.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @param[in] budget  Limits on the work done by this step.
+   /// @param[out] ctx    Context for logging and profiling.
+   /// @return Status of the search after this step. Once the search is no
+   ///         longer in progress, the problem should be finalised.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   SearchStatus IDAstarStep(IDAProblem<WS, H> &prob, const AS &actions, const Objects &objects, const Budget &budget, Context &ctx)
+   {
+      return BudgetedStep(IDAstarIteration<WS, H, AS>, prob, actions, objects, budget, ctx);
+   }
+
+   /// Finalise a completed IDAProblem into a Plan.
+   /// @param[in]  prob Problem to operate on.
+   /// @param[out] plan Plan to operate on.
+   /// @param[out] ctx  Context for logging and profiling.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   void IDAstarFinalise(const IDAProblem<WS, H> &prob, Plan &plan, Context &ctx)
+   {
+      if(prob.success)
+      {
+         // Steps lead backwards from the goal, so the last one is performed
+         // first.
+         std::vector<Plan::actionentry>::const_reverse_iterator it;
+         for(it = prob.steps.rbegin(); it != prob.steps.rend(); it++)
+            plan.push(it->action, it->parameters);
+      }
+      ctx.endPlanning();
+   }
+
+   /// Perform a complete regressive IDA* search.
+   /// @param[in]  init      Initial world state.
+   /// @param[in]  goal      Desired world state.
+   /// @param[in]  actions   Set of actions to operate with.
+   /// @param[in]  objects   Set of objects that exist in the problem.
+   /// @param[in]  heuristic Heuristic to guide the search with.
+   /// @param[out] plan      Plan output.
+   /// @param[out] ctx       Context for logging and profiling.
+   /// @return True if a valid plan was found, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool IDAstarSolve(const WS &init, const WS &goal,
+                     const AS &actions,
+                     const Objects &objects,
+                     const H &heuristic,
+                     Plan &plan,
+                     Context &ctx)
+   {
+      // Initialise problem with initial and goal states.
+      IDAProblem<WS, H> prob(heuristic);
+      if(!IDAstarInit(init, goal, prob, ctx))
+         return false;
+
+      // Iterate.
+      while(IDAstarIteration(prob, actions, objects, ctx)) {}
+
+      // Finalise and return success.
+      IDAstarFinalise(prob, plan, ctx);
+      return prob.success;
+   }
+
+   /// Perform a complete regressive IDA* search guided by the number of
+   /// predicates that differ from the initial state.
+   /// @see IDAstarSolve
+   /// @ingroup Aesop
+   template < class WS, class AS >
+   bool IDAstarSolve(const WS &init, const WS &goal,
+                     const AS &actions,
+                     const Objects &objects,
+                     Plan &plan,
+                     Context &ctx)
+   {
+      return IDAstarSolve(init, goal, actions, objects, GoalCountHeuristic(), plan, ctx);
+   }
+};
+
+#endif
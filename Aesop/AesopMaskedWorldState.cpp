@@ -0,0 +1,136 @@
+/// @file AesopMaskedWorldState.cpp
+/// Implementation of MaskedWorldState class as defined in AesopMaskedWorldState.h
+
+#include "AesopMaskedWorldState.h"
+
+namespace Aesop {
+   MaskedWorldState::MaskedWorldState(const Predicates &p) : WorldState(p)
+   {
+      mSize = getPredicates().size();
+      mValue.resize(wordCount(mSize));
+      mCare.resize(wordCount(mSize));
+      updateHash();
+   }
+
+   MaskedWorldState::~MaskedWorldState()
+   {
+   }
+
+   bool MaskedWorldState::isSet(Predicates::predID pred, const paramlist &params) const
+   {
+      return pred < mSize && (mValue[wordIndex(pred)] & bitMask(pred)) != 0;
+   }
+
+   bool MaskedWorldState::isUnset(Predicates::predID pred, const paramlist &params) const
+   {
+      return pred < mSize && (mCare[wordIndex(pred)] & ~mValue[wordIndex(pred)] & bitMask(pred)) != 0;
+   }
+
+   void MaskedWorldState::set(Predicates::predID pred, const paramlist &params)
+   {
+      if(pred < mSize)
+      {
+         unsigned int w = wordIndex(pred);
+         bitword value = mValue[w], care = mCare[w];
+         mValue[w] |= bitMask(pred);
+         mCare[w] |= bitMask(pred);
+         MaskedWorldState::rehashWord(w, value, care);
+      }
+   }
+
+   void MaskedWorldState::unset(Predicates::predID pred, const paramlist &params)
+   {
+      if(pred < mSize)
+      {
+         unsigned int w = wordIndex(pred);
+         bitword value = mValue[w], care = mCare[w];
+         mValue[w] &= ~bitMask(pred);
+         mCare[w] |= bitMask(pred);
+         MaskedWorldState::rehashWord(w, value, care);
+      }
+   }
+
+   void MaskedWorldState::clear(Predicates::predID pred, const paramlist &params)
+   {
+      if(pred < mSize)
+      {
+         unsigned int w = wordIndex(pred);
+         bitword value = mValue[w], care = mCare[w];
+         mValue[w] &= ~bitMask(pred);
+         mCare[w] &= ~bitMask(pred);
+         MaskedWorldState::rehashWord(w, value, care);
+      }
+   }
+
+   void MaskedWorldState::careAll()
+   {
+      for(unsigned int i = 0; i < mCare.size(); i++)
+         mCare[i] = ~(bitword)0;
+      // Keep bits beyond the last predicate clear.
+      if(mSize % wordBits)
+         mCare.back() = bitMask(mSize) - 1;
+      updateHash();
+   }
+
+   WorldState *MaskedWorldState::clone() const
+   {
+      return new MaskedWorldState(*this);
+   }
+
+   std::string MaskedWorldState::repr() const
+   {
+      std::string str = "{";
+      for(unsigned int p = 0; p < mSize; p++)
+      {
+         str += isSet(p) ? "t" : isUnset(p) ? "f" : "-";
+         if(p + 1 < mSize)
+            str += ", ";
+      }
+      str += "}";
+      return str;
+   }
+
+   unsigned int MaskedWorldState::compare(const MaskedWorldState &other) const
+   {
+      unsigned int diff = 0;
+      unsigned int n = mValue.size() < other.mValue.size() ? mValue.size() : other.mValue.size();
+      for(unsigned int i = 0; i < n; i++)
+         diff += popcount((mValue[i] ^ other.mValue[i]) & mCare[i] & other.mCare[i]);
+      return diff;
+   }
+
+   bool MaskedWorldState::satisfies(const MaskedWorldState &target) const
+   {
+      if(mValue.size() != target.mValue.size())
+         return false;
+      for(unsigned int i = 0; i < mValue.size(); i++)
+      {
+         if((target.mCare[i] & ~mCare[i]) | ((mValue[i] ^ target.mValue[i]) & target.mCare[i]))
+            return false;
+      }
+      return true;
+   }
+
+   void MaskedWorldState::getLiterals(SubsumptionIndex::literals &set) const
+   {
+      set.clear();
+      for(unsigned int i = 0; i < mCare.size(); i++)
+      {
+         bitword w = mCare[i];
+         while(w)
+         {
+            unsigned int p = i * wordBits + lowestBit(w);
+            set.push_back(p * 2 + ((mValue[i] & bitMask(p)) != 0));
+            w &= w - 1;
+         }
+      }
+   }
+
+   void MaskedWorldState::updateHash()
+   {
+      mHash = 0;
+      for(unsigned int i = 0; i < mValue.size(); i++)
+         mHash ^= zobristBits(i, mValue[i] & mCare[i], 1)
+                ^ zobristBits(i, ~mValue[i] & mCare[i], 0);
+   }
+};
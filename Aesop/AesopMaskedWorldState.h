@@ -0,0 +1,122 @@
+/// @file AesopMaskedWorldState.h
+/// Definition of MaskedWorldState class.
+
+#ifndef _AE_MASKED_WORLDSTATE_H_
+#define _AE_MASKED_WORLDSTATE_H_
+
+#include <vector>
+#include "abstract/AesopWorldState.h"
+#include "AesopBits.h"
+#include "AesopSubsumptionIndex.h"
+
+namespace Aesop {
+   /// WorldState of boolean predicates, any of which may be unknown.
+   ///
+   /// Each predicate has a value bit and a care bit, packed 64 to a word. A
+   /// predicate whose care bit is clear is neither set nor unset. This makes
+   /// the type suitable for goals that only mention some predicates, and for
+   /// the states of a regressive search, where an action's effects say
+   /// nothing about what those predicates were before it.
+   ///
+   /// Whether one state satisfies another, and whether one is more general
+   /// than another, are tested a word at a time.
+   ///
+   /// @ingroup Aesop
+   class MaskedWorldState : public WorldState {
+   public:
+      /// @name WorldState
+      /// @{
+
+      virtual bool isSet(Predicates::predID pred, const paramlist &params = paramlist()) const;
+      virtual bool isUnset(Predicates::predID pred, const paramlist &params = paramlist()) const;
+      virtual void set(Predicates::predID pred, const paramlist &params = paramlist());
+      virtual void unset(Predicates::predID pred, const paramlist &params = paramlist());
+      virtual void clear(Predicates::predID pred, const paramlist &params = paramlist());
+      virtual WorldState *clone() const;
+      virtual std::string repr() const;
+
+      /// Count the predicates that this state and another both care about
+      ///        but disagree on.
+      unsigned int compare(const MaskedWorldState &other) const;
+
+      virtual bool operator==(const MaskedWorldState &other) const
+      {
+         return mHash == other.mHash && mValue == other.mValue && mCare == other.mCare;
+      }
+
+      virtual bool operator!=(const MaskedWorldState &other) const
+      {
+         return !operator==(other);
+      }
+
+      virtual unsigned int bitWords() const { return mValue.size(); }
+      virtual const bitword *valueBits() const { return mValue.data(); }
+      virtual bitword *valueBits() { return mValue.data(); }
+      virtual const bitword *careBits() const { return mCare.data(); }
+      virtual bitword *careBits() { return mCare.data(); }
+      virtual void bitsChanged() { updateHash(); }
+      virtual void rehashWord(unsigned int word, bitword oldValue, bitword oldCare)
+      {
+         bitword set = (oldValue & oldCare) ^ (mValue[word] & mCare[word]);
+         bitword unset = (~oldValue & oldCare) ^ (~mValue[word] & mCare[word]);
+         mHash ^= zobristBits(word, set, 1) ^ zobristBits(word, unset, 0);
+      }
+
+      /// @}
+
+      /// Does this state have every value another state cares about?
+      /// @param[in] target State to check against.
+      /// @return True iff every predicate the target cares about is cared
+      ///         about here, with the same value.
+      bool satisfies(const MaskedWorldState &target) const;
+
+      /// Is this state more general than another? Any state that satisfies
+      ///        the other will also satisfy this one.
+      /// @param[in] other State to check against.
+      /// @return True iff the other state satisfies this one.
+      bool subsumes(const MaskedWorldState &other) const { return other.satisfies(*this); }
+
+      /// Get the literals this state asks for. Each literal is a predicate
+      ///        ID times two, plus one if the predicate should be set.
+      /// @param[out] set Ascending literals, replacing any contents.
+      void getLiterals(SubsumptionIndex::literals &set) const;
+
+      /// Care about every predicate, treating unknown ones as unset.
+      void careAll();
+
+      MaskedWorldState(const Predicates &p);
+      ~MaskedWorldState();
+
+   protected:
+   private:
+      /// Recompute our hash value from scratch.
+      void updateHash();
+
+      /// Number of predicates we store.
+      unsigned int mSize;
+      /// Packed predicate values. A value bit is always clear if its care
+      ///        bit is.
+      std::vector<bitword> mValue;
+      /// Packed bits that say which predicates have a known value.
+      std::vector<bitword> mCare;
+   };
+
+   /// A MaskedWorldState reaches a target when it satisfies it.
+   /// @see ReachedGoal
+   /// @ingroup Aesop
+   inline bool ReachedGoal(const MaskedWorldState &state, const MaskedWorldState &target)
+   {
+      return state.satisfies(target);
+   }
+
+   /// MaskedWorldStates can be indexed by the literals they ask for.
+   /// @see StateLiterals
+   /// @ingroup Aesop
+   inline bool StateLiterals(const MaskedWorldState &ws, SubsumptionIndex::literals &set)
+   {
+      ws.getLiterals(set);
+      return true;
+   }
+};
+
+#endif
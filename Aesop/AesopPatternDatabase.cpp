@@ -0,0 +1,185 @@
+/// @file AesopPatternDatabase.cpp
+/// Implementation of PatternDatabase class as defined in AesopPatternDatabase.h
+
+#include <limits>
+#include <queue>
+#include <functional>
+#include "AesopPatternDatabase.h"
+
+namespace Aesop {
+   const unsigned int PatternDatabase::maxPatternSize = 24;
+   const float PatternDatabase::unreachable = std::numeric_limits<float>::max();
+
+   PatternDatabase::PatternDatabase(const SimpleActionSet &actions)
+   {
+      mActions = &actions;
+      mRegressive = false;
+   }
+
+   bool PatternDatabase::addPattern(const pattern &p)
+   {
+      if(p.empty() || p.size() > maxPatternSize)
+         return false;
+      // Check for predicates used twice, in this or any other pattern.
+      pattern::const_iterator a, b;
+      for(a = p.begin(); a != p.end(); a++)
+      {
+         for(b = p.begin(); b != a; b++)
+         {
+            if(*a == *b)
+               return false;
+         }
+         std::vector<table>::const_iterator t;
+         for(t = mTables.begin(); t != mTables.end(); t++)
+         {
+            for(b = t->preds.begin(); b != t->preds.end(); b++)
+            {
+               if(*a == *b)
+                  return false;
+            }
+         }
+      }
+      mTables.push_back(table());
+      mTables.back().preds = p;
+      return true;
+   }
+
+   unsigned int PatternDatabase::size() const
+   {
+      unsigned int n = 0;
+      std::vector<table>::const_iterator t;
+      for(t = mTables.begin(); t != mTables.end(); t++)
+         n += t->costs.size();
+      return n;
+   }
+
+   /// An action restricted to the predicates of one pattern, as bit masks
+   /// over abstract state indices.
+   struct abstractaction {
+      /// Bits the action has a condition on, and their required values.
+      unsigned int condMask, condVal;
+      /// Bits the action changes, and their new values.
+      unsigned int effMask, effVal;
+      /// Cost of the action in this pattern.
+      float cost;
+   };
+
+   void PatternDatabase::build(const std::vector<bool> &anchor, const std::vector<bool> &known, const WorldState &ws, bool regressive)
+   {
+      mRegressive = regressive;
+      SimpleActionSet::const_iterator ac;
+      // Each action's cost goes to the first pattern it affects.
+      std::vector<bool> charged(mActions->size(), false);
+      std::vector<table>::iterator t;
+      for(t = mTables.begin(); t != mTables.end(); t++)
+      {
+         // Abstract each action that affects this pattern.
+         std::vector<abstractaction> abstract;
+         for(ac = mActions->begin(); ac != mActions->end(); ac++)
+         {
+            abstractaction a = {0, 0, 0, 0, 0.0f};
+            SimpleActionSet::literals list;
+            SimpleActionSet::literals::const_iterator l;
+            unsigned int i;
+            mActions->getConditions(ac, list);
+            for(l = list.begin(); l != list.end(); l++)
+            {
+               for(i = 0; i < t->preds.size(); i++)
+               {
+                  if(t->preds[i] == l->pred)
+                  {
+                     a.condMask |= 1 << i;
+                     if(l->set)
+                        a.condVal |= 1 << i;
+                  }
+               }
+            }
+            list.clear();
+            mActions->getEffects(ac, list);
+            for(l = list.begin(); l != list.end(); l++)
+            {
+               for(i = 0; i < t->preds.size(); i++)
+               {
+                  if(t->preds[i] == l->pred)
+                  {
+                     a.effMask |= 1 << i;
+                     if(l->set)
+                        a.effVal |= 1 << i;
+                  }
+               }
+            }
+            if(!a.effMask)
+               continue;
+            if(!charged[ac])
+            {
+               a.cost = mActions->cost(ac, WorldState::paramlist(), ws);
+               charged[ac] = true;
+            }
+            abstract.push_back(a);
+         }
+
+         // Dijkstra's algorithm over the abstract states, starting from
+         // every one the anchor could stand for.
+         unsigned int start = 0, unknown = 0, i;
+         for(i = 0; i < t->preds.size(); i++)
+         {
+            if(anchor[t->preds[i]])
+               start |= 1 << i;
+            else if(!known[t->preds[i]])
+               unknown |= 1 << i;
+         }
+         t->costs.assign(1 << t->preds.size(), unreachable);
+         typedef std::pair<float, unsigned int> entry;
+         std::priority_queue<entry, std::vector<entry>, std::greater<entry> > open;
+         unsigned int seed = 0;
+         do {
+            t->costs[start | seed] = 0.0f;
+            open.push(entry(0.0f, start | seed));
+            seed = (seed - unknown) & unknown;
+         } while(seed);
+         while(!open.empty())
+         {
+            entry e = open.top();
+            open.pop();
+            if(e.first > t->costs[e.second])
+               continue;
+            unsigned int s = e.second;
+            std::vector<abstractaction>::const_iterator a;
+            for(a = abstract.begin(); a != abstract.end(); a++)
+            {
+               float c = e.first + a->cost;
+               if(regressive)
+               {
+                  // Apply the action forwards from s.
+                  if((s & a->condMask) != a->condVal)
+                     continue;
+                  unsigned int n = (s & ~a->effMask) | a->effVal;
+                  if(c < t->costs[n])
+                  {
+                     t->costs[n] = c;
+                     open.push(entry(c, n));
+                  }
+                  continue;
+               }
+               // Find every state the action leads to s from. Values it
+               // changes without a condition could have been anything.
+               unsigned int keep = a->condMask & ~a->effMask;
+               if((s & a->effMask) != a->effVal || (s & keep) != (a->condVal & keep))
+                  continue;
+               unsigned int free = a->effMask & ~a->condMask;
+               unsigned int base = (s & ~(a->condMask | free)) | a->condVal;
+               unsigned int sub = 0;
+               do {
+                  unsigned int n = base | sub;
+                  if(c < t->costs[n])
+                  {
+                     t->costs[n] = c;
+                     open.push(entry(c, n));
+                  }
+                  sub = (sub - free) & free;
+               } while(sub);
+            }
+         }
+      }
+   }
+};
@@ -0,0 +1,159 @@
+/// @file AesopPatternDatabase.h
+/// Definition of PatternDatabase class and its heuristic.
+
+#ifndef _AE_PATTERN_DATABASE_H_
+#define _AE_PATTERN_DATABASE_H_
+
+#include <vector>
+#include "abstract/AesopWorldState.h"
+#include "AesopSimpleActionSet.h"
+
+namespace Aesop {
+   /// Tables of exact plan costs in simplified versions of a problem.
+   ///
+   /// Each pattern is a small set of predicates. Ignoring every other
+   /// predicate leaves an abstract problem with few enough states to search
+   /// completely, and the cost of reaching the goal in that abstraction can
+   /// never be more than the real cost. Tables are indexed directly by the
+   /// values of the pattern's predicates, so a pattern of k predicates costs
+   /// 2^k floats and lookups need no hashing.
+   ///
+   /// Patterns must not share predicates. The cost of each action is given to
+   /// the first pattern it affects and counts as zero in the others, so the
+   /// estimates of all patterns can be added together and still never exceed
+   /// the real cost.
+   ///
+   /// A database is built for one fixed state. For a progressive search this
+   /// is the goal, and the tables hold the cost of reaching it from every
+   /// abstract state. For a regressive search it is the initial state, and
+   /// the tables hold the cost of reaching every abstract state from it.
+   ///
+   /// States may leave predicates unknown, as partial goals and regressed
+   /// states do. An unknown predicate could have either value, so it stands
+   /// for every abstract state it could complete to: an anchor starts from
+   /// all of them at once, and a lookup takes the cheapest of them. Such a
+   /// lookup reads up to 2^u entries of a table, for u unknown predicates in
+   /// its pattern.
+   ///
+   /// @ingroup Aesop
+   class PatternDatabase {
+   public:
+      /// A list of predicates to keep in an abstraction.
+      typedef std::vector<Predicates::predID> pattern;
+
+      /// Largest number of predicates allowed in a single pattern.
+      static const unsigned int maxPatternSize;
+
+      /// Cost of an abstract state that can't be reached.
+      static const float unreachable;
+
+      /// Add a pattern to the database. Must be called before build.
+      /// @param[in] p Predicates to keep in the abstraction.
+      /// @return False if the pattern is empty, too large or shares a
+      ///         predicate with a pattern already added.
+      bool addPattern(const pattern &p);
+
+      /// Compute the tables of all patterns.
+      /// @param[in] anchor     State the tables are computed for.
+      /// @param[in] regressive Compute costs from the anchor, for use by a
+      ///                       regressive search, rather than to it.
+      template < class WS >
+      void build(const WS &anchor, bool regressive)
+      {
+         std::vector<bool> values(anchor.getPredicates().size());
+         std::vector<bool> known(values.size());
+         for(unsigned int p = 0; p < values.size(); p++)
+         {
+            values[p] = anchor.isSet(p, WorldState::paramlist());
+            known[p] = values[p] || anchor.isUnset(p, WorldState::paramlist());
+         }
+         build(values, known, anchor, regressive);
+      }
+
+      /// Estimate the cost of reaching one state from another. The anchor
+      ///        the database was built for must be the goal state of a
+      ///        progressive search, or the initial state of a regressive one.
+      /// @param[in] from State the plan would start in.
+      /// @param[in] to   State the plan would have to reach.
+      /// @return Sum of the costs in each pattern's table, or unreachable.
+      template < class WS >
+      float operator()(const WS &from, const WS &to) const
+      {
+         const WS &ws = mRegressive ? to : from;
+         float h = 0.0f;
+         std::vector<table>::const_iterator t;
+         for(t = mTables.begin(); t != mTables.end(); t++)
+         {
+            unsigned int index = 0, unknown = 0;
+            for(unsigned int i = 0; i < t->preds.size(); i++)
+            {
+               if(ws.isSet(t->preds[i], WorldState::paramlist()))
+                  index |= 1 << i;
+               else if(!ws.isUnset(t->preds[i], WorldState::paramlist()))
+                  unknown |= 1 << i;
+            }
+            // Unknown predicates could have either value, so take the
+            // cheapest entry over all of them.
+            float c = t->costs[index];
+            for(unsigned int sub = unknown; sub; sub = (sub - 1) & unknown)
+            {
+               if(t->costs[index | sub] < c)
+                  c = t->costs[index | sub];
+            }
+            if(c == unreachable)
+               return unreachable;
+            h += c;
+         }
+         return h;
+      }
+
+      /// Total number of entries in all tables.
+      unsigned int size() const;
+
+      /// Default constructor.
+      /// @param[in] actions Actions available in the problem.
+      PatternDatabase(const SimpleActionSet &actions);
+
+   protected:
+   private:
+      /// Cost table for a single pattern.
+      struct table {
+         /// Predicates in the pattern. Predicate i gives bit i of an index.
+         pattern preds;
+         /// Cost of each abstract state.
+         std::vector<float> costs;
+      };
+
+      /// Actions to abstract.
+      const SimpleActionSet *mActions;
+      /// Tables of all patterns.
+      std::vector<table> mTables;
+      /// Were the tables computed for a regressive search?
+      bool mRegressive;
+
+      /// Compute the tables of all patterns.
+      /// @param[in] anchor     Predicate values of the anchor state.
+      /// @param[in] known      Which predicates the anchor state knows.
+      /// @param[in] ws         The anchor state, used to get action costs.
+      /// @param[in] regressive Compute costs from the anchor rather than to it.
+      void build(const std::vector<bool> &anchor, const std::vector<bool> &known, const WorldState &ws, bool regressive);
+   };
+
+   /// Heuristic that looks up estimates in a PatternDatabase. It refers to
+   /// the database rather than copying it, so the database must outlive any
+   /// search that uses it.
+   /// @ingroup Aesop
+   class PatternHeuristic {
+   public:
+      template < class WS >
+      float operator()(const WS &from, const WS &to) const { return (*mDatabase)(from, to); }
+
+      PatternHeuristic(const PatternDatabase &db) : mDatabase(&db) {}
+
+   private:
+      /// Database to look estimates up in.
+      const PatternDatabase *mDatabase;
+   };
+};
+
+#endif
@@ -2,10 +2,17 @@
 /// Implementation of Plan class defined in AesopPlan.h
 
 #include "AesopPlan.h"
+#include <algorithm>
 
 namespace Aesop {
    void Plan::push(ActionSet::actionID action, WorldState::paramlist params)
    {
       mPlan.push_back(actionentry(action, params));
    }
+
+   void Plan::reverse(unsigned int first)
+   {
+      if(first < mPlan.size())
+         std::reverse(mPlan.begin() + first, mPlan.end());
+   }
 };
@@ -44,6 +44,18 @@ namespace Aesop {
       /// @param[in] params Parameters for the action.
       void push(ActionSet::actionID action, WorldState::paramlist params);
 
+      /// Reverse the order of the last actions in the Plan. Searches that
+      ///        discover a plan from its last step use this to put the
+      ///        steps they pushed in order.
+      /// @param[in] first Index of the first action to reverse.
+      void reverse(unsigned int first);
+
+      /// Number of actions in the Plan.
+      unsigned int size() const { return mPlan.size(); }
+
+      /// Remove all actions from the Plan.
+      void clear() { mPlan.clear(); }
+
    protected:
    private:
       /// Plan is a list of action entries.
@@ -0,0 +1,124 @@
+/// @file AesopPolicyTable.cpp
+/// Implementation of PolicyTable class as defined in AesopPolicyTable.h
+
+#include <limits>
+#include <queue>
+#include <functional>
+#include "AesopPolicyTable.h"
+
+namespace Aesop {
+   const float PolicyTable::unreachable = std::numeric_limits<float>::max();
+   const unsigned short PolicyTable::noAction = std::numeric_limits<unsigned short>::max();
+
+   unsigned long long PolicyTable::estimateSize(unsigned int predicates)
+   {
+      if(predicates >= 64)
+         return std::numeric_limits<unsigned long long>::max();
+      return (1ULL << predicates) * (sizeof(float) + sizeof(unsigned short));
+   }
+
+   PolicyTable::PolicyTable(const SimpleActionSet &actions, unsigned long long maxBytes)
+   {
+      mActions = &actions;
+      mMaxBytes = maxBytes;
+      mPredicates = 0;
+   }
+
+   void PolicyTable::build(unsigned int goal, const WorldState &ws)
+   {
+      // Convert actions to masks. Effects on predicates the table doesn't
+      // cover are ignored, but conditions on them can't be checked, so
+      // actions with such conditions are never used.
+      mMasks.clear();
+      std::vector<float> costs;
+      SimpleActionSet::const_iterator ac;
+      for(ac = mActions->begin(); ac != mActions->end() && ac < noAction; ac++)
+      {
+         action a = {0, 0, 0, 0};
+         SimpleActionSet::literals list;
+         SimpleActionSet::literals::const_iterator l;
+         bool usable = true;
+         mActions->getConditions(ac, list);
+         for(l = list.begin(); l != list.end(); l++)
+         {
+            if(l->pred >= mPredicates)
+            {
+               usable = false;
+               continue;
+            }
+            a.condMask |= 1u << l->pred;
+            if(l->set)
+               a.condVal |= 1u << l->pred;
+         }
+         list.clear();
+         mActions->getEffects(ac, list);
+         for(l = list.begin(); l != list.end(); l++)
+         {
+            if(l->pred >= mPredicates)
+               continue;
+            a.effMask |= 1u << l->pred;
+            if(l->set)
+               a.effVal |= 1u << l->pred;
+         }
+         // Unusable actions keep their place, so that masks stay indexed by
+         // action, but cost too much to ever be taken.
+         mMasks.push_back(a);
+         costs.push_back(usable ? mActions->cost(ac, WorldState::paramlist(), ws) : unreachable);
+      }
+
+      // Dijkstra's algorithm backwards from the goal.
+      mCosts.assign(1u << mPredicates, unreachable);
+      mBest.assign(1u << mPredicates, noAction);
+      mCosts[goal] = 0.0f;
+      typedef std::pair<float, unsigned int> entry;
+      std::priority_queue<entry, std::vector<entry>, std::greater<entry> > open;
+      open.push(entry(0.0f, goal));
+      while(!open.empty())
+      {
+         entry e = open.top();
+         open.pop();
+         unsigned int s = e.second;
+         if(e.first > mCosts[s])
+            continue;
+         for(unsigned int i = 0; i < mMasks.size(); i++)
+         {
+            if(costs[i] == unreachable)
+               continue;
+            const action &a = mMasks[i];
+            float c = e.first + costs[i];
+            // Find every state the action leads to s from. Values it changes
+            // without a condition could have been anything.
+            unsigned int keep = a.condMask & ~a.effMask;
+            if((s & a.effMask) != a.effVal || (s & keep) != (a.condVal & keep))
+               continue;
+            unsigned int free = a.effMask & ~a.condMask;
+            unsigned int base = (s & ~(a.condMask | free)) | a.condVal;
+            unsigned int sub = 0;
+            do {
+               unsigned int n = base | sub;
+               if(c < mCosts[n])
+               {
+                  mCosts[n] = c;
+                  mBest[n] = i;
+                  open.push(entry(c, n));
+               }
+               sub = (sub - free) & free;
+            } while(sub);
+         }
+      }
+   }
+
+   bool PolicyTable::solve(unsigned int init, Plan &plan) const
+   {
+      if(!built() || mCosts[init] == unreachable)
+         return false;
+      unsigned int s = init;
+      while(mBest[s] != noAction)
+      {
+         const action &a = mMasks[mBest[s]];
+         plan.push(mBest[s], WorldState::paramlist());
+         s = (s & ~a.effMask) | a.effVal;
+      }
+      return true;
+   }
+};
@@ -0,0 +1,129 @@
+/// @file AesopPolicyTable.h
+/// Definition of PolicyTable class.
+
+#ifndef _AE_POLICY_TABLE_H_
+#define _AE_POLICY_TABLE_H_
+
+#include <vector>
+#include "abstract/AesopWorldState.h"
+#include "AesopSimpleActionSet.h"
+#include "AesopPlan.h"
+
+namespace Aesop {
+   /// Precomputed cheapest plans from every state of a small domain to one
+   /// goal state.
+   ///
+   /// A state of a domain with n predicates is indexed by the n bits of its
+   /// predicate values, so every possible state has its own slot. Building
+   /// the table searches backwards from the goal once, recording the cost of
+   /// the cheapest plan and its first action for every state. After that,
+   /// planning from any state is a walk through the table that takes time in
+   /// proportion to the length of the plan.
+   ///
+   /// Memory use doubles with every predicate, so tables are only built for
+   /// domains whose estimated size is within a limit.
+   ///
+   /// @ingroup Aesop
+   class PolicyTable {
+   public:
+      /// Cost of a state from which the goal can't be reached.
+      static const float unreachable;
+
+      /// Estimate the memory needed to tabulate a domain.
+      /// @param[in] predicates Number of predicates in the domain.
+      /// @return Size of the table in bytes.
+      static unsigned long long estimateSize(unsigned int predicates);
+
+      /// Compute the table for a goal state.
+      /// @param[in] goal Desired world state.
+      /// @return False if the domain is too big to tabulate.
+      template < class WS >
+      bool build(const WS &goal)
+      {
+         unsigned int n = goal.getPredicates().size();
+         if(n >= 32 || estimateSize(n) > mMaxBytes)
+            return false;
+         mPredicates = n;
+         build(index(goal), goal);
+         return true;
+      }
+
+      /// Get the table index of a state.
+      /// @param[in] ws State to index.
+      /// @return Bits of the state's predicate values.
+      template < class WS >
+      unsigned int index(const WS &ws) const
+      {
+         unsigned int i = 0;
+         for(unsigned int p = 0; p < mPredicates; p++)
+         {
+            if(ws.isSet(p, WorldState::paramlist()))
+               i |= 1u << p;
+         }
+         return i;
+      }
+
+      /// Get the cost of the cheapest plan from a state to the goal.
+      /// @param[in] ws State to plan from.
+      /// @return Cost of the plan, or unreachable.
+      template < class WS >
+      float cost(const WS &ws) const { return mCosts[index(ws)]; }
+
+      /// Read the cheapest plan from a state to the goal out of the table.
+      /// @param[in]  init Initial world state.
+      /// @param[out] plan Plan output.
+      /// @return True if a plan exists, false if not.
+      template < class WS >
+      bool solve(const WS &init, Plan &plan) const
+      {
+         return solve(index(init), plan);
+      }
+
+      /// Has a table been built?
+      bool built() const { return !mCosts.empty(); }
+
+      /// Default constructor.
+      /// @param[in] actions  Actions available in the problem.
+      /// @param[in] maxBytes Largest table that may be built.
+      PolicyTable(const SimpleActionSet &actions, unsigned long long maxBytes = 1 << 24);
+
+   protected:
+   private:
+      /// Stored in place of an action for states with nothing left to do.
+      static const unsigned short noAction;
+
+      /// An action as bit masks over state indices.
+      struct action {
+         /// Bits the action has a condition on, and their required values.
+         unsigned int condMask, condVal;
+         /// Bits the action changes, and their new values.
+         unsigned int effMask, effVal;
+      };
+
+      /// Actions available in the problem.
+      const SimpleActionSet *mActions;
+      /// Actions as bit masks.
+      std::vector<action> mMasks;
+      /// Largest table that may be built.
+      unsigned long long mMaxBytes;
+      /// Number of predicates the table was built for.
+      unsigned int mPredicates;
+      /// Cost of the cheapest plan from each state.
+      std::vector<float> mCosts;
+      /// First action of the cheapest plan from each state.
+      std::vector<unsigned short> mBest;
+
+      /// Compute the table by searching backwards from the goal.
+      /// @param[in] goal Index of the goal state.
+      /// @param[in] ws   The goal state, used to get action costs.
+      void build(unsigned int goal, const WorldState &ws);
+
+      /// Read a plan out of the table.
+      /// @param[in]  init Index of the initial state.
+      /// @param[out] plan Plan output.
+      /// @return True if a plan exists, false if not.
+      bool solve(unsigned int init, Plan &plan) const;
+   };
+};
+
+#endif
@@ -5,15 +5,24 @@
 #define _AE_PROBLEM_H_
 
 #include <vector>
+#include <algorithm>
+#include <functional>
 #include "abstract/AesopActionSet.h"
+#include "AesopHashIndex.h"
+#include "AesopSubsumptionIndex.h"
+#include "AesopScratchState.h"
+#include "AesopArena.h"
+#include "AesopHeuristics.h"
 
 namespace Aesop {
    /// Stores planner instance data used by the planning algorithms.
+   /// @tparam WS        WorldState type being searched.
+   /// @tparam Heuristic Heuristic policy that guides the search.
    /// @ingroup Aesop
-   template < class WS >
+   template < class WS, class Heuristic = GoalCountHeuristic >
    class Problem {
    public:
-      typename typedef WS::paramlist paramlist;
+      typedef typename WS::paramlist paramlist;
 
       /// Was a plan successfully created?
       bool success;
@@ -21,15 +30,19 @@ namespace Aesop {
       /// State this problem is trying to reach.
       const WS *goal;
 
+      /// Estimates the cost of reaching one state from another.
+      Heuristic heuristic;
+
       /// Default constructor.
-      Problem() : goal(NULL), success(false), lastID(0) {}
+      /// @param[in] h Heuristic to guide the search with.
+      Problem(const Heuristic &h = Heuristic()) : success(false), goal(NULL), heuristic(h), collisions(0), subsumed(0), mPreferredTurn(false) {}
 
-      /// Store world states in the open list.
+      /// A node in the search: a state and the best known route to it.
       struct openstate {
          /// Intermediate WorldState.
          WS *state;
 
-         /// Identifier of this state.
+         /// Identifier of this node: its index in Problem::nodes.
          unsigned int ID;
 
          /// Total cost of this intermediate state.
@@ -48,6 +61,10 @@ namespace Aesop {
          /// Parameters to our action.
          paramlist params;
 
+         /// Was this state reached by an action the heuristic marked as
+         ///        helpful?
+         bool preferred;
+
          /// Default constructor.
          openstate()
          {
@@ -55,17 +72,20 @@ namespace Aesop {
             state = NULL;
             cost = G = H = 0.0f;
             parent = 0;
+            preferred = false;
             action = ActionSet::actionID();
             params = paramlist();
          }
 
-         /// Compare based on cost.
+         /// Compare based on cost, then prefer states reached by helpful
+         ///        actions.
          bool operator>(const openstate &s) const
-         { return cost > s.cost; }
+         { return s < *this; }
 
-         /// Compare based on cost.
+         /// Compare based on cost, then prefer states reached by helpful
+         ///        actions.
          bool operator<(const openstate &s) const
-         { return cost < s.cost; }
+         { return cost < s.cost || (cost == s.cost && preferred && !s.preferred); }
 
          /// Equality is based on the state represented, not auxiliary
          ///        data.
@@ -75,20 +95,393 @@ namespace Aesop {
          { return !operator==(s); }
       };
 
-      /// Open and closed lists use the same data type.
-      typedef std::vector<openstate> list;
+      /// Actions the heuristic marked as helpful in the state being
+      ///        expanded, indexed by ActionSet::const_iterator.
+      std::vector<bool> helpful;
+
+      /// Actions that match the state being expanded, as returned by
+      ///        ActionSet::getApplicable.
+      std::vector<bitword> applicable;
+
+      /// Successors of the state being expanded are generated here, and
+      ///        only copied into open list storage if they are kept.
+      ScratchState<WS> scratch;
+
+      /// Parameter combinations of the action being tried, as returned by
+      ///        ActionSet::getParamList.
+      ActionSet::paramcombos combos;
+
+      /// Every node created in this search, indexed by ID.
+      ///
+      /// Nodes never move or leave the arena until the Problem is reset, so
+      /// the open and closed lists refer to them by ID, and a reference to
+      /// a node stays valid while others are added.
+      Arena<openstate> nodes;
+
+      /// Storage for the WorldStates of nodes. States never move either,
+      ///        so nodes point straight at them, and several nodes may share
+      ///        one state.
+      Arena<WS> states;
+
+      /// Copy a WorldState into this Problem's storage.
+      /// @param[in] ws State to copy.
+      /// @return Copy that lives until the Problem is reset.
+      WS *store(const WS &ws)
+      {
+         return &states[states.add(ws)];
+      }
+
+      /// Add a node to the arena without opening it.
+      /// @param[in] s Node to copy. Its ID is ignored.
+      /// @return ID of the new node.
+      unsigned int add(const openstate &s)
+      {
+         unsigned int id = nodes.add(s);
+         nodes[id].ID = id;
+         return id;
+      }
+
+      /// Lists of node IDs.
+      typedef std::vector<unsigned int> list;
 
       /// Open list.
+      ///
+      /// The open list is kept as a d-ary min-heap of node IDs on cost. It
+      /// should only be modified through push, pop and improve, which keep
+      /// the heap and its index up to date.
       list open;
 
-      /// Closed list.
+      /// IDs of closed nodes, in the order they were closed.
       list closed;
 
-      /// ID counter for states.
-      unsigned int lastID;
+      /// Index of closed list entries by the hash of their states.
+      HashIndex closedIndex;
+
+      /// Number of closed list lookups that met a state with the same hash
+      ///        as the one being searched for, but a different value.
+      unsigned int collisions;
+
+      /// Find a state in the closed list.
+      /// @param[in] state WorldState to look for.
+      /// @return Index of the matching entry in the closed list, or
+      ///         HashIndex::None if the state has not been closed.
+      unsigned int findClosed(const WS &state)
+      {
+         unsigned int slot = HashIndex::None;
+         unsigned int i;
+         while((i = closedIndex.find(state.hash(), slot)) != HashIndex::None)
+         {
+            if(nodes[closed[i]].state->WS::operator==(state))
+               return i;
+            collisions++;
+         }
+         return HashIndex::None;
+      }
+
+      /// Add a node to the end of the closed list and index it.
+      /// @param[in] id ID of the node to close.
+      void close(unsigned int id)
+      {
+         const WS &state = *nodes[id].state;
+         closedIndex.insert(state.hash(), closed.size());
+         closed.push_back(id);
+         if(StateLiterals(state, mLiterals))
+            closedSubsumers.insert(mLiterals, nodes[id].G);
+      }
+
+      /// Index of the literals asked for by closed states, for WorldStates
+      ///        that leave some predicates unknown, with the cost each was
+      ///        reached at.
+      SubsumptionIndex closedSubsumers;
+
+      /// Number of states discarded because a closed state subsumed them.
+      unsigned int subsumed;
+
+      /// Is a state subsumed by one in the closed list that was reached at
+      ///        no greater cost? In a regressive search, such a state asks
+      ///        for everything the closed one does and more, so any plan that
+      ///        reaches it also reaches the closed state, and can finish from
+      ///        there just as cheaply. A closed state that was reached at a
+      ///        greater cost proves nothing.
+      /// @param[in] state WorldState to check.
+      /// @param[in] G     Cost the state was reached at.
+      /// @return True iff a closed state subsumes this one.
+      bool subsumedByClosed(const WS &state, float G)
+      {
+         return StateLiterals(state, mLiterals) && closedSubsumers.subsumed(mLiterals, G);
+      }
+
+      /// Find a closed state that a state satisfies, as ReachedGoal decides.
+      ///        States indexed by their literals are looked up through the
+      ///        subsumption index, and others by value.
+      /// @param[in] state State that has been reached.
+      /// @return Index in the closed list of a target the state satisfies,
+      ///         or HashIndex::None if there is none.
+      unsigned int findSatisfied(const WS &state)
+      {
+         if(!StateLiterals(state, mLiterals))
+            return findClosed(state);
+         if(!closedSubsumers.subsumed(mLiterals))
+            return HashIndex::None;
+         for(unsigned int i = 0; i < closed.size(); i++)
+         {
+            if(ReachedGoal(state, *nodes[closed[i]].state))
+               return i;
+         }
+         return HashIndex::None;
+      }
+
+      /// Find a closed state that satisfies a target, as ReachedGoal
+      ///        decides. States indexed by their literals are looked up
+      ///        through the subsumption index, and others by value.
+      /// @param[in] target State that is wanted.
+      /// @return Index in the closed list of a state that satisfies the
+      ///         target, or HashIndex::None if there is none.
+      unsigned int findSatisfying(const WS &target)
+      {
+         if(!StateLiterals(target, mLiterals))
+            return findClosed(target);
+         if(!closedSubsumers.subsumes(mLiterals))
+            return HashIndex::None;
+         for(unsigned int i = 0; i < closed.size(); i++)
+         {
+            if(ReachedGoal(*nodes[closed[i]].state, target))
+               return i;
+         }
+         return HashIndex::None;
+      }
+
+      /// Index of open list entries by the hash of their states. Entries are
+      ///        stored by node ID, which is stable while the heap moves.
+      HashIndex openIndex;
+
+      /// Position in the open list of each node ID, or HashIndex::None if
+      ///        the node is not in the open list.
+      std::vector<unsigned int> openPos;
+
+      /// An open node reached by a helpful action: its heuristic estimate
+      ///        and ID.
+      typedef std::pair<float, unsigned int> preferredEntry;
+
+      /// Open nodes reached by helpful actions, kept as a binary min-heap
+      ///        on heuristic estimate.
+      ///
+      /// pop() takes every other node from here rather than from the open
+      /// list, so helpful actions are followed greedily towards the goal
+      /// ahead of cheaper nodes that the heuristic has no reason to expand. Entries stay behind when
+      /// their node leaves the open list or is given an unhelpful path, and
+      /// are skipped when they reach the top.
+      std::vector<preferredEntry> preferredOpen;
+
+      /// Find a state in the open list.
+      /// @param[in] state WorldState to look for.
+      /// @return Position of the matching entry in the open list, or
+      ///         HashIndex::None if the state is not open.
+      unsigned int findOpen(const WS &state)
+      {
+         unsigned int slot = HashIndex::None;
+         unsigned int id;
+         while((id = openIndex.find(state.hash(), slot)) != HashIndex::None)
+         {
+            if(nodes[id].state->WS::operator==(state))
+               return openPos[id];
+            collisions++;
+         }
+         return HashIndex::None;
+      }
+
+      /// Add a new node to the open list.
+      /// @param[in] s Node to copy into the arena. Its ID is ignored.
+      /// @return ID of the new node.
+      unsigned int push(const openstate &s)
+      {
+         unsigned int id = add(s);
+         openPos.push_back(HashIndex::None);
+         openIndex.insert(s.state->hash(), id);
+         open.push_back(id);
+         siftUp(open.size() - 1);
+         if(s.preferred)
+            pushPreferred(id);
+         return id;
+      }
+
+      /// Remove the next node to expand from the open list. This is the
+      ///        cheapest node, except that every other call takes the node
+      ///        reached by a helpful action that looks closest to the goal,
+      ///        if one is open.
+      /// @return ID of the node that was removed.
+      unsigned int pop()
+      {
+         unsigned int pos = 0;
+         mPreferredTurn = !mPreferredTurn;
+         if(mPreferredTurn)
+         {
+            while(!preferredOpen.empty())
+            {
+               unsigned int p = preferredOpen.front().second;
+               std::pop_heap(preferredOpen.begin(), preferredOpen.end(), std::greater<preferredEntry>());
+               preferredOpen.pop_back();
+               if(openPos[p] != HashIndex::None && nodes[p].preferred)
+               {
+                  pos = openPos[p];
+                  break;
+               }
+            }
+         }
+         unsigned int id = open[pos];
+         openIndex.erase(nodes[id].state->hash(), id);
+         openPos[id] = HashIndex::None;
+         unsigned int moved = open.back();
+         open.pop_back();
+         if(moved != id)
+         {
+            // The last entry fills the gap, and may belong either above or
+            // below it.
+            place(pos, moved);
+            siftDown(pos);
+            siftUp(openPos[moved]);
+         }
+         return id;
+      }
+
+      /// Give an open node a cheaper path. The node keeps its own state
+      ///        and ID; only the path data is taken from the new one.
+      /// @param[in] pos Position of the node in the open list.
+      /// @param[in] s   Cheaper route to the same state.
+      void improve(unsigned int pos, const openstate &s)
+      {
+         openstate &o = nodes[open[pos]];
+         o.cost = s.cost;
+         o.G = s.G;
+         o.H = s.H;
+         o.parent = s.parent;
+         o.action = s.action;
+         o.params = s.params;
+         o.preferred = s.preferred;
+         siftUp(pos);
+         if(s.preferred)
+            pushPreferred(o.ID);
+      }
+
+      /// Restore the heap order of the open list after the costs of its
+      ///        nodes have been changed directly.
+      void reorder()
+      {
+         unsigned int i;
+         for(i = 0; i < open.size(); i++)
+            openPos[open[i]] = i;
+         for(i = open.size(); i-- > 0; )
+            siftDown(i);
+      }
+
+      /// Clear all search data ready for a new search, in constant time.
+      ///        Every list, table and arena keeps its storage, so a Problem
+      ///        that is reused for searches of similar size stops
+      ///        allocating memory.
+      void reset()
+      {
+         open.clear();
+         closed.clear();
+         nodes.reset();
+         states.reset();
+         openIndex.clear();
+         closedIndex.clear();
+         closedSubsumers.clear();
+         openPos.clear();
+         preferredOpen.clear();
+         mPreferredTurn = false;
+         collisions = 0;
+         subsumed = 0;
+         success = false;
+      }
    protected:
    private:
+      /// Scratch space for the literals of a state.
+      SubsumptionIndex::literals mLiterals;
+
+      /// Will the next pop() try the preferred queue first?
+      bool mPreferredTurn;
+
+      /// Add an open node to the preferred queue at its current estimate.
+      void pushPreferred(unsigned int id)
+      {
+         preferredOpen.push_back(preferredEntry(nodes[id].H, id));
+         std::push_heap(preferredOpen.begin(), preferredOpen.end(), std::greater<preferredEntry>());
+      }
+
+      /// Number of children of each node in the open heap.
+      static const unsigned int arity = 4;
+
+      /// Is one open node cheaper than another?
+      bool cheaper(unsigned int a, unsigned int b) const
+      { return nodes[a] < nodes[b]; }
+
+      /// Move an open list entry towards the root until the heap is valid.
+      void siftUp(unsigned int pos)
+      {
+         unsigned int id = open[pos];
+         while(pos > 0)
+         {
+            unsigned int parent = (pos - 1) / arity;
+            if(!cheaper(id, open[parent]))
+               break;
+            place(pos, open[parent]);
+            pos = parent;
+         }
+         place(pos, id);
+      }
+
+      /// Move an open list entry away from the root until the heap is valid.
+      void siftDown(unsigned int pos)
+      {
+         unsigned int id = open[pos];
+         unsigned int size = open.size();
+         while(true)
+         {
+            unsigned int first = pos * arity + 1;
+            if(first >= size)
+               break;
+            unsigned int last = first + arity < size ? first + arity : size;
+            unsigned int best = first;
+            for(unsigned int c = first + 1; c < last; c++)
+            {
+               if(cheaper(open[c], open[best]))
+                  best = c;
+            }
+            if(!cheaper(open[best], id))
+               break;
+            place(pos, open[best]);
+            pos = best;
+         }
+         place(pos, id);
+      }
+
+      /// Store a node ID at a position in the heap and record its position.
+      void place(unsigned int pos, unsigned int id)
+      {
+         open[pos] = id;
+         openPos[id] = pos;
+      }
    };
+
+   /// Get this thread's reusable Problem for a WorldState type and
+   /// heuristic.
+   ///
+   /// Solvers that run a whole search in one call use this workspace rather
+   /// than a fresh Problem, so that each search reuses the memory of the
+   /// last. The workspace lives until the thread exits.
+   ///
+   /// @param[in] h Heuristic to guide the next search with.
+   /// @return The workspace, with its heuristic set to h. It must not be
+   ///         used by more than one search at a time.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   Problem<WS, H> &ThreadProblem(const H &h)
+   {
+      static thread_local Problem<WS, H> prob(h);
+      prob.heuristic = h;
+      return prob;
+   }
 };
 
 #endif
@@ -4,25 +4,25 @@
 #ifndef _AE_REVERSE_ASTAR_H_
 #define _AE_REVERSE_ASTAR_H_
 
-#include <algorithm>
-#include <functional>
 #include "abstract/AesopWorldState.h"
 #include "abstract/AesopActionSet.h"
 #include "abstract/AesopObjects.h"
 #include "AesopProblem.h"
 #include "AesopPlan.h"
 #include "abstract/AesopContext.h"
+#include "AesopBudget.h"
 
 namespace Aesop {
-   /// Initialise a regressive A* solution.
+   /// Set up a Problem for a regressive A* search, without telling a Context
+   ///        that planning has begun. Searches built out of this one use it
+   ///        so that planning only begins once.
    /// @param[in]  init Initial world state for this problem.
    /// @param[in]  goal Desired world state for this problem.
    /// @param[out] prob Problem object to initialise.
-   /// @param[out] ctx  Context for logging and profiling.
    /// @return True if initialisation was successful, false if not.
    /// @ingroup Aesop
-   template < class WS >
-   bool ReverseAstarInit(const WS &init, const WS &goal, Problem<WS> &prob, Context &ctx)
+   template < class WS, class H >
+   bool ReverseAstarStart(const WS &init, const WS &goal, Problem<WS, H> &prob)
    {
       // Check that the predicates used by each state match.
       if(init.getPredicates() != goal.getPredicates())
@@ -30,16 +30,30 @@ namespace Aesop {
          //ctx.
          return false;
       }
-      ctx.beginPlanning();
       // Goal is actually initial state since we're doing a regressive search.
       prob.goal = &init;
       // Clear problem data.
-      prob.open.clear();
-      prob.closed.clear();
-      prob.success = false;
+      prob.reset();
       // Push the first state onto the open list.
-      prob.open.push_back(Problem<WS>::openstate());
-      prob.open.back().state = new WS(goal);
+      typename Problem<WS, H>::openstate s;
+      s.state = prob.store(goal);
+      prob.push(s);
+      return true;
+   }
+
+   /// Initialise a regressive A* solution.
+   /// @param[in]  init Initial world state for this problem.
+   /// @param[in]  goal Desired world state for this problem.
+   /// @param[out] prob Problem object to initialise.
+   /// @param[out] ctx  Context for logging and profiling.
+   /// @return True if initialisation was successful, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   bool ReverseAstarInit(const WS &init, const WS &goal, Problem<WS, H> &prob, Context &ctx)
+   {
+      if(!ReverseAstarStart(init, goal, prob))
+         return false;
+      ctx.beginPlanning();
       return true;
    }
 
@@ -50,8 +64,8 @@ namespace Aesop {
    /// @param[out] ctx    Context for logging and profiling.
    /// @return True if the algorithm should continue, false if not.
    /// @ingroup Aesop
-   template < class WS >
-   bool ReverseAstarIteration(Problem<WS> &prob, const ActionSet &actions, const Objects &objects, Context &ctx)
+   template < class WS, class H, class AS >
+   bool ReverseAstarIteration(Problem<WS, H> &prob, const AS &actions, const Objects &objects, Context &ctx)
    {
       ctx.beginIteration();
 
@@ -62,14 +76,22 @@ namespace Aesop {
          return false;
       }
 
-      pop_heap(prob.open.begin(), prob.open.end(), std::greater<Problem<WS>::openstate>());
-      Problem<WS>::openstate s = prob.open.back();
-      prob.open.pop_back();
+      unsigned int id = prob.pop();
+      const typename Problem<WS, H>::openstate &s = prob.nodes[id];
+
+      // A state that was opened before something more general was closed
+      // at no greater cost needn't be expanded.
+      if(prob.subsumedByClosed(*s.state, s.G))
+      {
+         prob.subsumed++;
+         ctx.endIteration();
+         return true;
+      }
 
       ctx.toClosed(s.ID);
-      prob.closed.push_back(s);
+      prob.close(id);
 
-      if(*s.state == *prob.goal)
+      if(ReachedGoal(*prob.goal, *s.state))
       {
          ctx.success();
          ctx.endIteration();
@@ -77,71 +99,78 @@ namespace Aesop {
          return false;
       }
 
+      // Ask the heuristic which actions could best lead here.
+      bool prefer = HelpfulActions(prob.heuristic, *prob.goal, *s.state, true, prob.helpful);
+
+      // Find the actions that could lead here.
+      bool exact = GetApplicable(actions, *s.state, true, prob.applicable);
+
+      // Successors are generated in place, in the scratch state.
+      WS &next = prob.scratch.begin(*s.state);
+
       // For each action we can take
+      ActionSet::paramcombos &plist = prob.combos;
+      const ActionSet::const_iterator last = ActionsEnd(actions);
       ActionSet::const_iterator it;
-      for(it = actions.begin(); it != actions.end(); it++)
+      for(it = nextBit(prob.applicable, ActionsBegin(actions)); it < last; it = nextBit(prob.applicable, it + 1))
       {
          // Get list of parameter combinations.
-         ActionSet::paramcombos plist;
-         actions.getParamList(it, plist, objects);
+         plist.clear();
+         GetParamList(actions, it, plist, objects);
          ActionSet::paramcombos::const_iterator p;
          // For each valid parameter combination:
          for(p = plist.begin(); p != plist.end(); p++)
          {
             // If the action doesn't post-match this world state, continue.
-            if(!actions.postMatch(it, *p, *s.state))
+            if(!exact && !PostMatch(actions, it, *p, *s.state))
                continue;
             // Create a new world state by applying the action in reverse.
-            Problem<WS>::openstate n;
-            n.ID = prob.lastID++;
-            n.state = new WS(*s.state);
-            actions.applyReverse(it, *p, *n.state);
+            ApplyReverseScratch(actions, it, *p, prob.scratch);
+            typename Problem<WS, H>::openstate n;
             n.action = it;
             n.params = *p;
+            n.preferred = prefer && prob.helpful[it];
             //ctx.newState(n);
             // If the new state is already in the closed list, continue.
-            Problem<WS>::list::const_iterator cli;
-            for(cli = prob.closed.begin(); cli != prob.closed.end(); cli++)
+            if(prob.findClosed(next) != HashIndex::None)
             {
-               if(*n.state == *cli->state)
-               {
-                  //ctx.
-                  delete n.state;
-                  break;
-               }
-            }
-            if(cli != prob.closed.end())
+               //ctx.
+               prob.scratch.undo();
                continue;
+            }
             // Parent is last item in closed list.
             n.parent = prob.closed.size() - 1;
             // Calculate cost.
-            n.G = s.G + 1;
-            n.H = (float)s.state->compare(*prob.goal);
+            n.G = s.G + ActionCost(actions, it, *p, next);
+            // Likewise if it asks for more than a closed state does, and
+            // costs no less to reach.
+            if(prob.subsumedByClosed(next, n.G))
+            {
+               prob.subsumed++;
+               prob.scratch.undo();
+               continue;
+            }
+            // Estimate the cost of reaching the new state from the initial
+            // state.
+            n.H = prob.heuristic(*prob.goal, next);
             n.cost = n.G + n.H;
             // Check whether state is already in the open list; if so, we may
             // update its cost.
-            Problem<WS>::list::iterator oli;
-            // Check to see if the world state is already in the open list.
-            for(oli = prob.open.begin(); oli != prob.open.end(); oli++)
+            unsigned int oi = prob.findOpen(next);
+            if(oi == HashIndex::None)
             {
-               if(*n.state == *oli->state && n < *oli)
-               {
-                  //ctx.
-                  // We've found a more efficient way of getting here.
-                  *oli = n;
-                  // Reorder the heap.
-                  make_heap(prob.open.begin(), prob.open.end(),
-                     std::greater<Problem<WS>::openstate>());
-                  break;
-               }
+               //ctx.
+               // Only now does the state need storage of its own.
+               n.state = prob.store(next);
+               prob.push(n);
             }
-            // Push onto the open list if not already in it.
-            if(oli == prob.open.end())
+            else
             {
-               //ctx.
-               prob.open.push_back(n);
-               push_heap(prob.open.begin(), prob.open.end(), std::greater<Problem<WS>::openstate>());
+               // We've found a more efficient way of getting here.
+               if(n < prob.nodes[prob.open[oi]])
+                  prob.improve(oi, n);
             }
+            prob.scratch.undo();
          }
       }
 
@@ -149,46 +178,64 @@ namespace Aesop {
       return true;
    }
 
+   /// Perform as many iterations of a regressive A* search as a budget allows.
+   /// @param     prob    Problem to operate on.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @param[in] budget  Limits on the work done by this step.
+   /// @param[out] ctx    Context for logging and profiling.
+   /// @return Status of the search after this step. Once the search is no
+   ///         longer in progress, the problem should be finalised.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   SearchStatus ReverseAstarStep(Problem<WS, H> &prob, const AS &actions, const Objects &objects, const Budget &budget, Context &ctx)
+   {
+      return BudgetedStep(ReverseAstarIteration<WS, H, AS>, prob, actions, objects, budget, ctx);
+   }
+
    /// Finalise a completed Problem into a Plan.
    /// @param[in]  prob Problem to operate on.
    /// @param[out] plan Plan to operate on.
    /// @param[out] ctx  Context for logging and profiling.
    /// @ingroup Aesop
-   template < class WS >
-   void ReverseAstarFinalise(const Problem<WS> &prob, Plan &plan, Context &ctx)
+   template < class WS, class H >
+   void ReverseAstarFinalise(const Problem<WS, H> &prob, Plan &plan, Context &ctx)
    {
       if(prob.success)
       {
          unsigned int i = prob.closed.size() - 1;
          while(i)
          {
+            const typename Problem<WS, H>::openstate &n = prob.nodes[prob.closed[i]];
             // Extract the action performed at this step and its parameters.
-            plan.push(prob.closed[i].action, prob.closed[i].params);
+            plan.push(n.action, n.params);
             // Iterate.
-            i = prob.closed[i].parent;
+            i = n.parent;
          }
       }
       ctx.endPlanning();
    }
 
    /// Perform a complete regressive A* search.
-   /// @param[in]  init    Initial world state.
-   /// @param[in]  goal    Desired world state.
-   /// @param[in]  actions Set of actions to operate with.
-   /// @param[in]  objects Set of objects that exist in the problem.
-   /// @param[out] plan    Plan output.
-   /// @param[out] ctx     Context for logging and profiling.
+   /// @param[in]  init      Initial world state.
+   /// @param[in]  goal      Desired world state.
+   /// @param[in]  actions   Set of actions to operate with.
+   /// @param[in]  objects   Set of objects that exist in the problem.
+   /// @param[in]  heuristic Heuristic to guide the search with.
+   /// @param[out] plan      Plan output.
+   /// @param[out] ctx       Context for logging and profiling.
    /// @return True if a valid plan was found, false if not.
    /// @ingroup Aesop
-   template < class WS >
+   template < class WS, class H, class AS >
    bool ReverseAstarSolve(const WS &init, const WS &goal,
-                          const ActionSet &actions,
+                          const AS &actions,
                           const Objects &objects,
+                          const H &heuristic,
                           Plan &plan,
                           Context &ctx)
    {
-      // Initialise problem with initial and goal states.
-      Problem<WS> prob;
+      // Initialise this thread's workspace with initial and goal states.
+      Problem<WS, H> &prob = ThreadProblem<WS>(heuristic);
       if(!ReverseAstarInit(init, goal, prob, ctx))
          return false;
 
@@ -199,6 +246,34 @@ namespace Aesop {
       ReverseAstarFinalise(prob, plan, ctx);
       return prob.success;
    }
+
+   /// Perform a complete regressive A* search, guided by the number of
+   /// predicates that differ from the initial state.
+   /// @see ReverseAstarSolve
+   /// @ingroup Aesop
+   template < class WS, class AS >
+   bool ReverseAstarSolve(const WS &init, const WS &goal,
+                          const AS &actions,
+                          const Objects &objects,
+                          Plan &plan,
+                          Context &ctx)
+   {
+      return ReverseAstarSolve(init, goal, actions, objects, GoalCountHeuristic(), plan, ctx);
+   }
+
+   /// Perform a complete regressive uniform-cost search. This finds the
+   /// cheapest plan without using a heuristic at all.
+   /// @see ReverseAstarSolve
+   /// @ingroup Aesop
+   template < class WS, class AS >
+   bool UniformCostSolve(const WS &init, const WS &goal,
+                         const AS &actions,
+                         const Objects &objects,
+                         Plan &plan,
+                         Context &ctx)
+   {
+      return ReverseAstarSolve(init, goal, actions, objects, NullHeuristic(), plan, ctx);
+   }
 };
 
 #endif
@@ -0,0 +1,736 @@
+/// @file AesopSMAstar.h
+/// Implementation of regressive simplified memory-bounded A* search.
+
+#ifndef _AE_SMASTAR_H_
+#define _AE_SMASTAR_H_
+
+#include <vector>
+#include <functional>
+#include <limits>
+#include "abstract/AesopWorldState.h"
+#include "abstract/AesopActionSet.h"
+#include "abstract/AesopObjects.h"
+#include "AesopHashIndex.h"
+#include "AesopScratchState.h"
+#include "AesopHeuristics.h"
+#include "AesopPlan.h"
+#include "abstract/AesopContext.h"
+#include "AesopBudget.h"
+
+namespace Aesop {
+   /// Stores planner instance data used by the SMA* algorithm.
+   ///
+   /// At most maxNodes states are held in memory at once. Expanding a state
+   /// lists all of its successors and their costs, but successors are
+   /// stored one at a time, cheapest first, each time the state is the most
+   /// promising thing to explore. When a new state would exceed the memory
+   /// limit, the worst leaf of the search tree is forgotten. Its parent keeps
+   /// its cost, so that it can be generated again, no more optimistically
+   /// than before, if it turns out to be the most promising.
+   ///
+   /// The cost of an expanded state is backed up from its successors, so it
+   /// rises as the search learns more about what lies below it. Paths too
+   /// deep to fit in memory can't be finished, so they cost infinity.
+   ///
+   /// maxNodes bounds the number of states, but not the successor lists of
+   /// expanded states, which hold an entry for every action that applies.
+   /// Memory use is therefore up to maxNodes times the branching factor of
+   /// the domain in successors, on top of maxNodes states. Lists keep their
+   /// storage when their slot is reused, so a reused SMAProblem stops
+   /// allocating once it has seen the widest expansions.
+   ///
+   /// @ingroup Aesop
+   template < class WS, class H = GoalCountHeuristic >
+   class SMAProblem {
+   public:
+      typedef typename WS::paramlist paramlist;
+
+      /// Was a plan successfully created?
+      bool success;
+
+      /// State this problem is trying to reach.
+      const WS *goal;
+
+      /// Maximum number of states to keep in memory.
+      unsigned int maxNodes;
+
+      /// Estimates the cost of reaching one state from another.
+      H heuristic;
+
+      /// Default constructor.
+      /// @param[in] h Heuristic to guide the search with.
+      SMAProblem(const H &h = H())
+         : success(false), goal(NULL), maxNodes(0), heuristic(h), lastID(0),
+         result(HashIndex::None), mExpanding(HashIndex::None), mUsed(0) {}
+
+      /// A successor of an expanded state.
+      struct successor {
+         /// The action that leads to the successor.
+         ActionSet::const_iterator action;
+
+         /// Parameters to the action.
+         paramlist params;
+
+         /// Total cost of the successor. While it is in memory this
+         ///        follows its own cost, so once forgotten it keeps what was
+         ///        learnt about it.
+         float cost;
+
+         /// Node holding the successor, or HashIndex::None if it isn't in
+         ///        memory.
+         unsigned int node;
+      };
+
+      /// A state in the search tree.
+      struct node {
+         /// Identifier of this state.
+         unsigned int ID;
+
+         /// Total cost of this intermediate state. Once it is expanded,
+         ///        this is the cost of its cheapest successor.
+         float cost,
+         /// Cost accrued to get to this state.
+            G;
+
+         /// Node this state was reached from, or HashIndex::None for the
+         ///        root of the tree.
+         unsigned int parent;
+
+         /// Which of its parent's successors this state is.
+         unsigned int index;
+
+         /// Number of steps from the root of the tree.
+         unsigned int depth;
+
+         /// Number of successors currently held in memory.
+         unsigned int children;
+
+         /// Has this state been expanded?
+         bool expanded;
+
+         /// Successors of this state, once it has been expanded. There is
+         ///        one for each applicable action, whether or not it is in
+         ///        memory, so this isn't bounded by maxNodes.
+         std::vector<successor> successors;
+
+         /// Is this state in the queue of states to explore?
+         bool queued;
+
+         /// Cost this state is queued with.
+         float key;
+
+         /// Is this state among the leaves that may be forgotten?
+         bool leaf;
+
+         /// Default constructor.
+         node()
+         {
+            ID = 0;
+            cost = G = key = 0.0f;
+            parent = index = HashIndex::None;
+            depth = children = 0;
+            expanded = queued = leaf = false;
+         }
+      };
+
+      /// Storage for all nodes in memory.
+      std::vector<node> nodes;
+
+      /// The state of each node, stored in the slot of the same index.
+      ///        States of forgotten nodes, and of earlier searches, are kept
+      ///        to be assigned over when their slot is reused.
+      std::vector<WS> states;
+
+      /// Successors are generated in this before being stored.
+      ScratchState<WS> scratch;
+
+      /// ID counter for states.
+      unsigned int lastID;
+
+      /// Node that reached the goal, once the search succeeds.
+      unsigned int result;
+
+      /// Actions that match the state being expanded, as returned by
+      ///        ActionSet::getApplicable.
+      std::vector<bitword> applicable;
+
+      /// Parameter combinations of the action being tried, as returned by
+      ///        ActionSet::getParamList.
+      ActionSet::paramcombos combos;
+
+      /// Add a node to memory.
+      /// @param[in] ws     State of the node.
+      /// @param[in] parent Node this state is a successor of, or
+      ///                   HashIndex::None for the root of the tree.
+      /// @param[in] index  Which of the parent's successors it is.
+      /// @param[in] G      Cost accrued to get to this state.
+      /// @param[in] cost   Total cost of this state.
+      /// @return Index of the node in storage.
+      unsigned int store(const WS &ws, unsigned int parent, unsigned int index, float G, float cost)
+      {
+         unsigned int i;
+         if(mFree.empty())
+         {
+            i = nodes.size();
+            nodes.push_back(node());
+         }
+         else
+         {
+            i = mFree.back();
+            mFree.pop_back();
+         }
+         if(i < states.size())
+            states[i] = ws;
+         else
+            states.push_back(ws);
+         mUsed++;
+         node &n = nodes[i];
+         n.ID = lastID++;
+         n.cost = cost;
+         n.G = G;
+         n.parent = parent;
+         n.index = index;
+         n.depth = parent == HashIndex::None ? 0 : nodes[parent].depth + 1;
+         n.children = 0;
+         n.expanded = false;
+         // Keep the successor list's memory for reuse.
+         n.successors.clear();
+         if(parent != HashIndex::None)
+         {
+            unlink(parent);
+            nodes[parent].successors[index].node = i;
+            nodes[parent].children++;
+            link(parent);
+         }
+         link(i);
+         return i;
+      }
+
+      /// Number of nodes currently in memory.
+      unsigned int size() const { return mUsed; }
+
+      /// Is there anything left worth exploring?
+      bool empty() const { return mOpen.empty(); }
+
+      /// Take the most promising node out of the queue to explore it.
+      ///        It is put back by done.
+      /// @return Index of the node.
+      unsigned int best()
+      {
+         unsigned int i = mOpen.top().index;
+         unlink(i);
+         mExpanding = i;
+         return i;
+      }
+
+      /// Finish exploring the node taken by best, and queue it again if it
+      ///        still has successors to generate.
+      void done()
+      {
+         unsigned int i = mExpanding;
+         mExpanding = HashIndex::None;
+         link(i);
+      }
+
+      /// Get the least promising leaf in memory that could be forgotten.
+      ///        The node being explored and the root are never chosen.
+      /// @return Index of the node, or HashIndex::None if there is none.
+      unsigned int worst() const
+      {
+         return mLeaves.empty() ? HashIndex::None : mLeaves.top().index;
+      }
+
+      /// Forget a leaf. Its parent keeps its cost, so that it can be
+      ///        generated again later.
+      /// @param[in] i   Index of the leaf to forget.
+      /// @param[out] ctx Context for logging and profiling.
+      void forget(unsigned int i, Context &ctx)
+      {
+         unlink(i);
+         ctx.forgotten(nodes[i].ID);
+         unsigned int p = nodes[i].parent;
+         unlink(p);
+         nodes[p].successors[nodes[i].index].node = HashIndex::None;
+         nodes[p].children--;
+         link(p);
+         mFree.push_back(i);
+         mUsed--;
+      }
+
+      /// Back a node's cost up through its ancestors after it has risen.
+      ///        Each ancestor costs as much as its cheapest successor.
+      /// @param[in] i Index of the node.
+      void backup(unsigned int i)
+      {
+         const float infinity = std::numeric_limits<float>::max();
+         unsigned int p;
+         for(p = nodes[i].parent; p != HashIndex::None; i = p, p = nodes[p].parent)
+         {
+            node &pn = nodes[p];
+            unlink(p);
+            pn.successors[nodes[i].index].cost = nodes[i].cost;
+            float c = infinity;
+            for(unsigned int k = 0; k < pn.successors.size(); k++)
+            {
+               if(pn.successors[k].cost < c)
+                  c = pn.successors[k].cost;
+            }
+            bool raised = c > pn.cost;
+            if(raised)
+               pn.cost = c;
+            link(p);
+            if(!raised)
+               break;
+         }
+      }
+
+      /// Make room for a number of nodes, so that searches of that size
+      ///        don't allocate memory for their bookkeeping.
+      /// @param[in] n Number of nodes.
+      void reserve(unsigned int n)
+      {
+         nodes.reserve(n);
+         states.reserve(n);
+         mFree.reserve(n);
+         mOpen.reserve(n);
+         mLeaves.reserve(n);
+      }
+
+      /// Clear all search data. Stored states are kept to be assigned over.
+      void reset()
+      {
+         nodes.clear();
+         mFree.clear();
+         mOpen.clear();
+         mLeaves.clear();
+         mUsed = 0;
+         lastID = 0;
+         result = mExpanding = HashIndex::None;
+         success = false;
+      }
+   protected:
+   private:
+      /// Key that orders nodes by cost, with deeper nodes first among
+      ///        those of equal cost.
+      struct entry {
+         float cost;
+         unsigned int depth;
+         unsigned int index;
+         entry(float c, unsigned int d, unsigned int i) : cost(c), depth(d), index(i) {}
+         bool operator<(const entry &e) const
+         {
+            if(cost != e.cost)
+               return cost < e.cost;
+            if(depth != e.depth)
+               return depth > e.depth;
+            return index < e.index;
+         }
+      };
+
+      /// Orders entries from last to first.
+      struct later {
+         bool operator()(const entry &a, const entry &b) const
+         { return b < a; }
+      };
+
+      /// Binary heap of node entries, with the first by Before on top, from
+      ///        which any node can be removed. Its storage is kept when it
+      ///        is cleared.
+      template < class Before >
+      class entryHeap {
+      public:
+         bool empty() const { return mHeap.empty(); }
+
+         /// First entry in the heap.
+         const entry &top() const { return mHeap.front(); }
+
+         void reserve(unsigned int n)
+         {
+            mHeap.reserve(n);
+            mPos.reserve(n);
+         }
+
+         void clear()
+         {
+            mHeap.clear();
+            mPos.clear();
+         }
+
+         /// Add an entry for a node that isn't in the heap.
+         void insert(const entry &e)
+         {
+            if(mPos.size() <= e.index)
+               mPos.resize(e.index + 1, HashIndex::None);
+            mHeap.push_back(e);
+            siftUp(mHeap.size() - 1);
+         }
+
+         /// Remove the entry of a node that is in the heap.
+         void erase(unsigned int index)
+         {
+            unsigned int pos = mPos[index];
+            mPos[index] = HashIndex::None;
+            entry moved = mHeap.back();
+            mHeap.pop_back();
+            if(pos < mHeap.size())
+            {
+               // The last entry fills the gap, and may belong either above
+               // or below it.
+               place(pos, moved);
+               siftDown(pos);
+               siftUp(mPos[moved.index]);
+            }
+         }
+
+      private:
+         std::vector<entry> mHeap;
+         /// Position in the heap of each node index.
+         std::vector<unsigned int> mPos;
+         Before before;
+
+         void siftUp(unsigned int pos)
+         {
+            entry e = mHeap[pos];
+            while(pos > 0)
+            {
+               unsigned int parent = (pos - 1) / 2;
+               if(!before(e, mHeap[parent]))
+                  break;
+               place(pos, mHeap[parent]);
+               pos = parent;
+            }
+            place(pos, e);
+         }
+
+         void siftDown(unsigned int pos)
+         {
+            entry e = mHeap[pos];
+            unsigned int size = mHeap.size();
+            while(true)
+            {
+               unsigned int child = pos * 2 + 1;
+               if(child >= size)
+                  break;
+               if(child + 1 < size && before(mHeap[child + 1], mHeap[child]))
+                  child++;
+               if(!before(mHeap[child], e))
+                  break;
+               place(pos, mHeap[child]);
+               pos = child;
+            }
+            place(pos, e);
+         }
+
+         void place(unsigned int pos, const entry &e)
+         {
+            mHeap[pos] = e;
+            mPos[e.index] = pos;
+         }
+      };
+
+      /// Take a node out of the queue and the leaves, before its cost or
+      ///        its successors change.
+      void unlink(unsigned int i)
+      {
+         if(i == mExpanding)
+            return;
+         node &n = nodes[i];
+         if(n.queued)
+            mOpen.erase(i);
+         if(n.leaf)
+            mLeaves.erase(i);
+         n.queued = n.leaf = false;
+      }
+
+      /// Put a node back into the queue and the leaves, as it now belongs.
+      ///        An unexpanded node is queued with its own cost, and an
+      ///        expanded one with the cost of its cheapest successor that
+      ///        isn't in memory.
+      void link(unsigned int i)
+      {
+         if(i == mExpanding)
+            return;
+         const float infinity = std::numeric_limits<float>::max();
+         node &n = nodes[i];
+         n.key = n.expanded ? infinity : n.cost;
+         for(unsigned int k = 0; k < n.successors.size(); k++)
+         {
+            if(n.successors[k].node == HashIndex::None && n.successors[k].cost < n.key)
+               n.key = n.successors[k].cost;
+         }
+         n.queued = n.key != infinity;
+         if(n.queued)
+            mOpen.insert(entry(n.key, n.depth, i));
+         n.leaf = !n.children && n.parent != HashIndex::None;
+         if(n.leaf)
+            mLeaves.insert(entry(n.cost, n.depth, i));
+      }
+
+      /// Node currently being explored, or HashIndex::None.
+      unsigned int mExpanding;
+
+      /// Nodes with something left to explore, most promising on top.
+      entryHeap< std::less<entry> > mOpen;
+
+      /// Nodes with no successors in memory, which may be forgotten. The
+      ///        worst is on top.
+      entryHeap<later> mLeaves;
+
+      /// Unused slots in the node storage.
+      std::vector<unsigned int> mFree;
+
+      /// Number of slots in use.
+      unsigned int mUsed;
+   };
+
+   /// Initialise a regressive SMA* solution.
+   /// @param[in]  init     Initial world state for this problem.
+   /// @param[in]  goal     Desired world state for this problem.
+   /// @param[in]  maxNodes Maximum number of states to hold in memory.
+   /// @param[out] prob     Problem object to initialise.
+   /// @param[out] ctx      Context for logging and profiling.
+   /// @return True if initialisation was successful, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   bool SMAstarInit(const WS &init, const WS &goal, unsigned int maxNodes, SMAProblem<WS, H> &prob, Context &ctx)
+   {
+      // Check that the predicates used by each state match.
+      if(init.getPredicates() != goal.getPredicates() || !maxNodes)
+      {
+         //ctx.
+         return false;
+      }
+      ctx.beginPlanning();
+      // Goal is actually initial state since we're doing a regressive search.
+      prob.goal = &init;
+      prob.maxNodes = maxNodes;
+      // Clear problem data.
+      prob.reset();
+      prob.reserve(maxNodes);
+      // Store the root of the search tree.
+      prob.store(goal, HashIndex::None, HashIndex::None, 0.0f, prob.heuristic(init, goal));
+      return true;
+   }
+
+   /// Perform a single iteration in a regressive SMA* search. The most
+   /// promising node is either expanded, if it hasn't been yet, or has its
+   /// cheapest successor that isn't in memory generated.
+   /// @param     prob    Problem to operate on.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @param[out] ctx    Context for logging and profiling.
+   /// @return True if the algorithm should continue, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool SMAstarIteration(SMAProblem<WS, H> &prob, const AS &actions, const Objects &objects, Context &ctx)
+   {
+      typedef typename SMAProblem<WS, H>::node node;
+      typedef typename SMAProblem<WS, H>::successor successor;
+      const float infinity = std::numeric_limits<float>::max();
+
+      ctx.beginIteration();
+
+      // If nothing has a finite cost, no plan fits in memory.
+      if(prob.empty())
+      {
+         ctx.failure();
+         ctx.endIteration();
+         return false;
+      }
+
+      unsigned int s = prob.best();
+      ctx.toClosed(prob.nodes[s].ID);
+
+      if(!prob.nodes[s].expanded)
+      {
+         if(ReachedGoal(*prob.goal, prob.states[s]))
+         {
+            ctx.success();
+            ctx.endIteration();
+            prob.result = s;
+            prob.success = true;
+            return false;
+         }
+
+         // List every successor and its cost, without storing any yet.
+         node &n = prob.nodes[s];
+         bool exact = GetApplicable(actions, prob.states[s], true, prob.applicable);
+         WS &ws = prob.scratch.begin(prob.states[s]);
+         float best = infinity;
+         // For each action we can take
+         ActionSet::paramcombos &plist = prob.combos;
+         const ActionSet::const_iterator last = ActionsEnd(actions);
+         ActionSet::const_iterator it;
+         for(it = nextBit(prob.applicable, ActionsBegin(actions)); it < last; it = nextBit(prob.applicable, it + 1))
+         {
+            // Get list of parameter combinations.
+            plist.clear();
+            GetParamList(actions, it, plist, objects);
+            ActionSet::paramcombos::const_iterator p;
+            // For each valid parameter combination:
+            for(p = plist.begin(); p != plist.end(); p++)
+            {
+               // If the action doesn't post-match this world state, continue.
+               if(!exact && !PostMatch(actions, it, *p, ws))
+                  continue;
+               // Apply the action in reverse to the scratch state.
+               ApplyReverseScratch(actions, it, *p, prob.scratch);
+               // Don't revisit states on the path to this one.
+               unsigned int a;
+               for(a = s; a != HashIndex::None; a = prob.nodes[a].parent)
+               {
+                  if(ws == prob.states[a])
+                     break;
+               }
+               if(a == HashIndex::None)
+               {
+                  successor next;
+                  next.action = it;
+                  next.params = *p;
+                  next.node = HashIndex::None;
+                  // Calculate cost. A successor can never be cheaper than
+                  // this state.
+                  next.cost = n.G + ActionCost(actions, it, *p, ws) + prob.heuristic(*prob.goal, ws);
+                  if(next.cost < n.cost)
+                     next.cost = n.cost;
+                  // A state that isn't the goal is useless if there's no
+                  // memory left to extend the path past it.
+                  unsigned int depth = n.depth + 1;
+                  if(depth >= prob.maxNodes ||
+                     (depth + 1 >= prob.maxNodes && !ReachedGoal(*prob.goal, ws)))
+                     next.cost = infinity;
+                  if(next.cost < best)
+                     best = next.cost;
+                  n.successors.push_back(next);
+               }
+               prob.scratch.undo();
+            }
+         }
+         n.expanded = true;
+         // This state is worth no less than its cheapest successor.
+         if(best > n.cost)
+         {
+            n.cost = best;
+            prob.backup(s);
+         }
+      }
+      else
+      {
+         // Generate the cheapest successor that isn't in memory. It keeps
+         // the cost it was forgotten with.
+         const node &n = prob.nodes[s];
+         unsigned int k = HashIndex::None;
+         for(unsigned int c = 0; c < n.successors.size(); c++)
+         {
+            if(n.successors[c].node == HashIndex::None &&
+               (k == HashIndex::None || n.successors[c].cost < n.successors[k].cost))
+               k = c;
+         }
+         const successor &next = n.successors[k];
+         WS &ws = prob.scratch.begin(prob.states[s]);
+         ApplyReverse(actions, next.action, next.params, ws);
+         float G = n.G + ActionCost(actions, next.action, next.params, ws);
+         float cost = next.cost;
+         // Make room for the new state if we have to. There is always a
+         // leaf off the path to this state to forget, since the path is
+         // never allowed to fill memory.
+         if(prob.size() >= prob.maxNodes)
+            prob.forget(prob.worst(), ctx);
+         prob.store(ws, s, k, G, cost);
+      }
+
+      prob.done();
+      ctx.endIteration();
+      return true;
+   }
+
+   /// Perform as many iterations of a regressive SMA* search as a budget
+   /// allows.
+   /// @param     prob    Problem to operate on.
+   /// @param[in] actions Set of actions to operate with.
+   /// @param[in] objects Set of objects that exist in the problem.
+   /// @param[in] budget  Limits on the work done by this step.
+   /// @param[out] ctx    Context for logging and profiling.
+   /// @return Status of the search after this step. Once the search is no
+   ///         longer in progress, the problem should be finalised.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   SearchStatus SMAstarStep(SMAProblem<WS, H> &prob, const AS &actions, const Objects &objects, const Budget &budget, Context &ctx)
+   {
+      return BudgetedStep(SMAstarIteration<WS, H, AS>, prob, actions, objects, budget, ctx);
+   }
+
+   /// Finalise a completed SMAProblem into a Plan.
+   /// @param[in]  prob Problem to operate on.
+   /// @param[out] plan Plan to operate on.
+   /// @param[out] ctx  Context for logging and profiling.
+   /// @ingroup Aesop
+   template < class WS, class H >
+   void SMAstarFinalise(const SMAProblem<WS, H> &prob, Plan &plan, Context &ctx)
+   {
+      if(prob.success)
+      {
+         unsigned int i = prob.result;
+         while(prob.nodes[i].parent != HashIndex::None)
+         {
+            // Extract the action performed at this step and its parameters.
+            const typename SMAProblem<WS, H>::node &n = prob.nodes[i];
+            const typename SMAProblem<WS, H>::successor &step = prob.nodes[n.parent].successors[n.index];
+            plan.push(step.action, step.params);
+            // Iterate.
+            i = n.parent;
+         }
+      }
+      ctx.endPlanning();
+   }
+
+   /// Perform a complete regressive SMA* search.
+   /// @param[in]  init      Initial world state.
+   /// @param[in]  goal      Desired world state.
+   /// @param[in]  actions   Set of actions to operate with.
+   /// @param[in]  objects   Set of objects that exist in the problem.
+   /// @param[in]  heuristic Heuristic to guide the search with.
+   /// @param[in]  maxNodes  Maximum number of states to hold in memory.
+   /// @param[out] plan      Plan output.
+   /// @param[out] ctx       Context for logging and profiling.
+   /// @return True if a valid plan was found, false if not.
+   /// @ingroup Aesop
+   template < class WS, class H, class AS >
+   bool SMAstarSolve(const WS &init, const WS &goal,
+                     const AS &actions,
+                     const Objects &objects,
+                     const H &heuristic,
+                     unsigned int maxNodes,
+                     Plan &plan,
+                     Context &ctx)
+   {
+      // Initialise problem with initial and goal states.
+      SMAProblem<WS, H> prob(heuristic);
+      if(!SMAstarInit(init, goal, maxNodes, prob, ctx))
+         return false;
+
+      // Iterate.
+      while(SMAstarIteration(prob, actions, objects, ctx)) {}
+
+      // Finalise and return success.
+      SMAstarFinalise(prob, plan, ctx);
+      return prob.success;
+   }
+
+   /// Perform a complete regressive SMA* search guided by the number of
+   /// predicates that differ from the initial state.
+   /// @see SMAstarSolve
+   /// @ingroup Aesop
+   template < class WS, class AS >
+   bool SMAstarSolve(const WS &init, const WS &goal,
+                     const AS &actions,
+                     const Objects &objects,
+                     unsigned int maxNodes,
+                     Plan &plan,
+                     Context &ctx)
+   {
+      return SMAstarSolve(init, goal, actions, objects, GoalCountHeuristic(), maxNodes, plan, ctx);
+   }
+};
+
+#endif
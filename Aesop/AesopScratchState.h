@@ -0,0 +1,177 @@
+/// @file AesopScratchState.h
+/// Definition of ScratchState class template and in-place action application.
+
+#ifndef _AE_SCRATCH_STATE_H_
+#define _AE_SCRATCH_STATE_H_
+
+#include <vector>
+#include "abstract/AesopWorldState.h"
+#include "abstract/AesopActionSet.h"
+#include "AesopBits.h"
+
+namespace Aesop {
+   /// A WorldState that successors are generated in, by applying an action
+   /// and then undoing it.
+   ///
+   /// Solvers copy the state being expanded into the scratch state once, then
+   /// apply each action to it in place. A successor only needs to be copied
+   /// into storage of its own if it turns out not to be a duplicate.
+   ///
+   /// ActionSets that know which packed words an action changes record just
+   /// those words before changing them, and undoing restores only those
+   /// words. Otherwise the whole state is saved before the action is applied.
+   ///
+   /// Actions may be applied on top of each other, as a depth-first search
+   /// does along its path, and each undo reverses the most recent action
+   /// that has not been undone yet.
+   ///
+   /// @tparam WS WorldState type. Scratch states are always of exactly this
+   ///            type, so their methods may be called without virtual
+   ///            dispatch.
+   /// @ingroup Aesop
+   template < class WS >
+   class ScratchState {
+   public:
+      /// Start generating successors of a state.
+      /// @param[in] ws State to copy into the scratch state.
+      /// @return The scratch state.
+      WS &begin(const WS &ws)
+      {
+         if(mState.empty())
+            mState.push_back(ws);
+         else
+            mState[0] = ws;
+         mChanges.clear();
+         mApplied.clear();
+         mCopies = 0;
+         return mState[0];
+      }
+
+      /// Get the scratch state. begin must have been called first.
+      WS &state() { return mState[0]; }
+
+      /// Save the whole scratch state before applying an action, so that
+      ///        any change it makes can be undone.
+      void save()
+      {
+         if(mCopies == mCopy.size())
+            mCopy.push_back(mState[0]);
+         else
+            mCopy[mCopies] = mState[0];
+         mCopies++;
+         applied a = {(unsigned int)mChanges.size(), true};
+         mApplied.push_back(a);
+      }
+
+      /// Record a packed word of the scratch state before an action changes
+      ///        it. Once the action has changed every word it recorded, call
+      ///        changed.
+      /// @param[in] word Index of the word.
+      void record(unsigned int word)
+      {
+         const bitword *care = mState[0].WS::careBits();
+         change c = {word, mState[0].WS::valueBits()[word], care ? care[word] : 0};
+         mChanges.push_back(c);
+      }
+
+      /// Update the scratch state's hash after an action has changed the
+      ///        words it recorded.
+      void changed()
+      {
+         unsigned int first = mApplied.empty() ? 0 : mApplied.back().end;
+         for(unsigned int c = first; c < mChanges.size(); c++)
+            mState[0].WS::rehashWord(mChanges[c].word, mChanges[c].value, mChanges[c].care);
+         applied a = {(unsigned int)mChanges.size(), false};
+         mApplied.push_back(a);
+      }
+
+      /// Return the scratch state to how it was before the last action that
+      ///        is still applied.
+      void undo()
+      {
+         WS &ws = mState[0];
+         applied a = mApplied.back();
+         mApplied.pop_back();
+         if(a.saved)
+         {
+            ws = mCopy[--mCopies];
+            return;
+         }
+         unsigned int first = mApplied.empty() ? 0 : mApplied.back().end;
+         bitword *value = ws.WS::valueBits();
+         bitword *care = ws.WS::careBits();
+         for(unsigned int c = a.end; c-- > first; )
+         {
+            bitword v = value[mChanges[c].word];
+            bitword k = care ? care[mChanges[c].word] : 0;
+            value[mChanges[c].word] = mChanges[c].value;
+            if(care)
+               care[mChanges[c].word] = mChanges[c].care;
+            ws.WS::rehashWord(mChanges[c].word, v, k);
+         }
+         mChanges.resize(first);
+      }
+
+      /// Default constructor.
+      ScratchState() : mCopies(0) {}
+
+   protected:
+   private:
+      /// The previous contents of a packed word.
+      struct change {
+         unsigned int word;
+         bitword value, care;
+      };
+      typedef std::vector<change> changelist;
+
+      /// An action that has been applied and not undone.
+      struct applied {
+         /// End of its changes in mChanges. They start where the previous
+         ///        action's end.
+         unsigned int end;
+         /// Was the whole state saved instead?
+         bool saved;
+      };
+
+      /// Holds the scratch state once begin has been called. WorldStates
+      ///        have no default constructor, so it can't be a plain member.
+      std::vector<WS> mState;
+      /// Words changed by the actions still applied, oldest first.
+      changelist mChanges;
+      /// Actions still applied, oldest first.
+      std::vector<applied> mApplied;
+      /// Whole states saved by actions still applied, oldest first. Entries
+      ///        past mCopies are kept to be assigned over.
+      std::vector<WS> mCopy;
+      /// Number of entries of mCopy in use.
+      unsigned int mCopies;
+   };
+
+   /// @name Static dispatch
+   /// Apply actions to a ScratchState so that they can be undone. By default
+   /// the whole state is saved first; ActionSets that know which words an
+   /// action changes may overload these to record only those.
+   /// @{
+
+   /// @see ActionSet::applyForward
+   /// @ingroup Aesop
+   template < class AS, class WS >
+   void ApplyForwardScratch(const AS &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, ScratchState<WS> &scratch)
+   {
+      scratch.save();
+      ApplyForward(actions, ac, params, scratch.state());
+   }
+
+   /// @see ActionSet::applyReverse
+   /// @ingroup Aesop
+   template < class AS, class WS >
+   void ApplyReverseScratch(const AS &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, ScratchState<WS> &scratch)
+   {
+      scratch.save();
+      ApplyReverse(actions, ac, params, scratch.state());
+   }
+
+   /// @}
+};
+
+#endif
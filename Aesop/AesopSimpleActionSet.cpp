@@ -2,6 +2,9 @@
 /// Implementation of SimpleActionSet class as defined in AesopSimpleActionSet.h
 
 #include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 #include "AesopSimpleActionSet.h"
 
 namespace Aesop {
@@ -10,10 +13,23 @@ namespace Aesop {
    /// Each action in this class of ActionSet may be conditional upon predicates
    /// being set or unset with no parameters. Actions may also set these
    /// predicates to true or false with no parameters.
+   ///
+   /// Each action is compiled to bit masks as it is added. When the WorldState
+   /// it is used with exposes packed bits, matching and applying the action
+   /// works on whole words instead of calling the WorldState per predicate.
+   /// The masks of all actions are also kept in a table that getApplicable
+   /// sweeps to test a state against every action in one call. When built
+   /// with AVX2 enabled, four actions are tested at a time.
+   ///
+   /// An index from each predicate value to the actions that achieve it lets
+   /// regression of partial states consider only the actions that achieve
+   /// something the state asks for.
 
    SimpleActionSet::SimpleActionSet(const Predicates &p)
       : ActionSet(p)
    {
+      mWords = 0;
+      mStride = 0;
    }
 
    SimpleActionSet::~SimpleActionSet()
@@ -72,23 +88,285 @@ namespace Aesop {
 
    void SimpleActionSet::add()
    {
+      compile(mCurrAction);
       mActions.push_back(mCurrAction);
+      addToTable(mActions.size() - 1);
    }
 
-   bool SimpleActionSet::has(actionID ac) const
+   /// Copy a mask table into one with a different layout.
+   /// @param     table     Table to move, laid out as [w * stride + a].
+   /// @param[in] words     Number of words in the old layout.
+   /// @param[in] stride    Entries for each word in the old layout.
+   /// @param[in] count     Number of actions in the table.
+   /// @param[in] newWords  Number of words in the new layout.
+   /// @param[in] newStride Entries for each word in the new layout.
+   static void relayout(std::vector<bitword> &table,
+                        unsigned int words, unsigned int stride, unsigned int count,
+                        unsigned int newWords, unsigned int newStride)
    {
-      return ac < mActions.size();
+      std::vector<bitword> moved(newWords * newStride, 0);
+      for(unsigned int w = 0; w < words; w++)
+         std::copy(table.begin() + w * stride, table.begin() + w * stride + count,
+                   moved.begin() + w * newStride);
+      table.swap(moved);
    }
 
-   void SimpleActionSet::getParamList(const_iterator ac, paramcombos &list, const Objects &objects) const
+   void SimpleActionSet::addToTable(unsigned int a)
    {
-      list.clear();
-      list.push_back(WorldState::paramlist());
+      const SimpleAction &action = mActions[a];
+      // Leave room for more actions after this one, so that adding each
+      // action only rearranges the table a logarithmic number of times.
+      unsigned int stride = mStride;
+      if(a >= stride)
+         stride = std::max(stride * 2, 4u);
+      unsigned int words = std::max(mWords, action.words);
+      if(stride != mStride || words != mWords)
+      {
+         relayout(mCondMask, mWords, mStride, a, words, stride);
+         relayout(mCondVal, mWords, mStride, a, words, stride);
+         relayout(mWantMask, mWords, mStride, a, words, stride);
+         relayout(mWantVal, mWords, mStride, a, words, stride);
+         relayout(mEffMask, mWords, mStride, a, words, stride);
+         mWords = words;
+         mStride = stride;
+      }
+      SimpleAction::masklist::const_iterator m;
+      for(m = action.masks.begin(); m != action.masks.end(); m++)
+      {
+         unsigned int i = m->word * mStride + a;
+         mCondMask[i] = m->condMask;
+         mCondVal[i] = m->condVal;
+         mWantMask[i] = m->effMask | m->condMask;
+         mWantVal[i] = m->effVal | (m->condVal & ~m->effMask);
+         mEffMask[i] = m->effMask;
+      }
+
+      // Every achiever bitmap covers all the actions.
+      unsigned int rows = wordCount(mActions.size());
+      std::vector<std::vector<bitword> >::iterator row;
+      if(rows != wordCount(a))
+      {
+         for(row = mAchievers.begin(); row != mAchievers.end(); row++)
+         {
+            if(!row->empty())
+               row->resize(rows, 0);
+         }
+      }
+      SimpleAction::predslist::const_iterator it;
+      for(it = action.predicates.begin(); it != action.predicates.end(); it++)
+      {
+         if(it->eff == SimpleAction::None)
+            continue;
+         unsigned int l = it->pred * 2 + (it->eff == SimpleAction::Set);
+         if(mAchievers.size() <= l)
+            mAchievers.resize(l + 1);
+         if(mAchievers[l].empty())
+            mAchievers[l].assign(rows, 0);
+         mAchievers[l][wordIndex(a)] |= bitMask(a);
+      }
+   }
+
+   void SimpleActionSet::getAchievers(Predicates::predID pred, bool set, std::vector<const_iterator> &list) const
+   {
+      unsigned int l = pred * 2 + set;
+      if(l >= mAchievers.size() || mAchievers[l].empty())
+         return;
+      for(unsigned int a = nextBit(mAchievers[l], 0); a < mActions.size(); a = nextBit(mAchievers[l], a + 1))
+         list.push_back(a);
+   }
+
+   bool SimpleActionSet::tableForward(unsigned int a, const bitword *value, const bitword *care) const
+   {
+      bitword bad = 0;
+      for(unsigned int w = 0, i = a; w < mWords; w++, i += mStride)
+      {
+         bad |= (value[w] & mCondMask[i]) ^ mCondVal[i];
+         if(care)
+            bad |= (care[w] & mCondMask[i]) ^ mCondMask[i];
+      }
+      return !bad;
+   }
+
+   bool SimpleActionSet::tableReverse(unsigned int a, const bitword *value, const bitword *care) const
+   {
+      bitword bad = 0, relevant = 0;
+      for(unsigned int w = 0, i = a; w < mWords; w++, i += mStride)
+      {
+         bitword known = care ? care[w] : ~(bitword)0;
+         bitword differ = value[w] ^ mWantVal[i];
+         bad |= known & mWantMask[i] & differ;
+         relevant |= known & mEffMask[i] & ~differ;
+      }
+      return !bad && relevant;
+   }
+
+   bool SimpleActionSet::getApplicable(const WorldState &ws, bool reverse, std::vector<bitword> &result) const
+   {
+      unsigned int words = ws.bitWords();
+      unsigned int rows = wordCount(mActions.size());
+      std::vector<std::vector<bitword> >::const_iterator row;
+      if(!words || words < mWords)
+      {
+         if(!reverse)
+            return ActionSet::getApplicable(ws, reverse, result);
+         // Only actions that achieve something the state asks for are
+         // candidates for regressing it.
+         result.assign(rows, 0);
+         for(row = mAchievers.begin(); row != mAchievers.end(); row++)
+         {
+            unsigned int l = row - mAchievers.begin();
+            if(row->empty())
+               continue;
+            if(l % 2 ? ws.isSet(l / 2, WorldState::paramlist())
+                     : ws.isUnset(l / 2, WorldState::paramlist()))
+            {
+               for(unsigned int i = 0; i < rows; i++)
+                  result[i] |= (*row)[i];
+            }
+         }
+         return false;
+      }
+      return maskApplicable(ws.valueBits(), ws.careBits(), words, reverse, result);
+   }
+
+   bool SimpleActionSet::maskApplicable(const bitword *value, const bitword *care, unsigned int words, bool reverse, std::vector<bitword> &result) const
+   {
+      unsigned int rows = wordCount(mActions.size());
+      result.assign(rows, 0);
+      if(reverse && care)
+      {
+         // A partial state usually asks for few predicates, so gather the
+         // actions that achieve them and test only those.
+         unsigned int n = std::min(words, wordCount(mAchievers.size() / 2 + 1));
+         for(unsigned int w = 0; w < n; w++)
+         {
+            for(bitword c = care[w]; c; c &= c - 1)
+            {
+               unsigned int p = w * wordBits + lowestBit(c);
+               unsigned int l = p * 2 + ((value[w] & bitMask(p)) != 0);
+               if(l >= mAchievers.size() || mAchievers[l].empty())
+                  continue;
+               for(unsigned int i = 0; i < rows; i++)
+                  result[i] |= mAchievers[l][i];
+            }
+         }
+         for(unsigned int a = nextBit(result, 0); a < mActions.size(); a = nextBit(result, a + 1))
+         {
+            if(!tableReverse(a, value, care))
+               result[wordIndex(a)] &= ~bitMask(a);
+         }
+         return true;
+      }
+      unsigned int a = 0;
+#if defined(__AVX2__)
+      // Test four actions at a time. Groups of four never straddle a word
+      // of the result.
+      const __m256i zero = _mm256_setzero_si256();
+      for(; a + 4 <= mActions.size(); a += 4)
+      {
+         __m256i bad = zero, relevant = zero;
+         for(unsigned int w = 0, i = a; w < mWords; w++, i += mStride)
+         {
+            __m256i v = _mm256_set1_epi64x((long long)value[w]);
+            __m256i known = _mm256_set1_epi64x(care ? (long long)care[w] : -1LL);
+            if(reverse)
+            {
+               __m256i differ = _mm256_xor_si256(v, _mm256_loadu_si256((const __m256i*)&mWantVal[i]));
+               __m256i want = _mm256_and_si256(known, _mm256_loadu_si256((const __m256i*)&mWantMask[i]));
+               __m256i eff = _mm256_and_si256(known, _mm256_loadu_si256((const __m256i*)&mEffMask[i]));
+               bad = _mm256_or_si256(bad, _mm256_and_si256(want, differ));
+               relevant = _mm256_or_si256(relevant, _mm256_andnot_si256(differ, eff));
+            }
+            else
+            {
+               __m256i cm = _mm256_loadu_si256((const __m256i*)&mCondMask[i]);
+               __m256i cv = _mm256_loadu_si256((const __m256i*)&mCondVal[i]);
+               bad = _mm256_or_si256(bad, _mm256_xor_si256(_mm256_and_si256(v, cm), cv));
+               bad = _mm256_or_si256(bad, _mm256_xor_si256(_mm256_and_si256(known, cm), cm));
+            }
+         }
+         __m256i ok = _mm256_cmpeq_epi64(bad, zero);
+         if(reverse)
+            ok = _mm256_andnot_si256(_mm256_cmpeq_epi64(relevant, zero), ok);
+         bitword bits = (bitword)_mm256_movemask_pd(_mm256_castsi256_pd(ok));
+         result[wordIndex(a)] |= bits << (a % wordBits);
+      }
+#endif
+      for(; a < mActions.size(); a++)
+      {
+         if(reverse ? tableReverse(a, value, care) : tableForward(a, value, care))
+            result[wordIndex(a)] |= bitMask(a);
+      }
+      return true;
+   }
+
+   void SimpleActionSet::compile(SimpleAction &action)
+   {
+      action.masks.clear();
+      action.words = 0;
+      SimpleAction::predslist::const_iterator it;
+      for(it = action.predicates.begin(); it != action.predicates.end(); it++)
+      {
+         unsigned int w = wordIndex(it->pred);
+         bitword bit = bitMask(it->pred);
+         // Find or insert the masks for this word, keeping them in order.
+         SimpleAction::masklist::iterator m = action.masks.begin();
+         while(m != action.masks.end() && m->word < w)
+            m++;
+         if(m == action.masks.end() || m->word != w)
+         {
+            SimpleAction::maskword mw = {w, 0, 0, 0, 0};
+            m = action.masks.insert(m, mw);
+         }
+         if(it->cond != SimpleAction::None)
+         {
+            m->condMask |= bit;
+            if(it->cond == SimpleAction::Set)
+               m->condVal |= bit;
+         }
+         if(it->eff != SimpleAction::None)
+         {
+            m->effMask |= bit;
+            if(it->eff == SimpleAction::Set)
+               m->effVal |= bit;
+         }
+         if(w + 1 > action.words)
+            action.words = w + 1;
+      }
+   }
+
+   void SimpleActionSet::getConditions(const_iterator ac, literals &list) const
+   {
+      const SimpleAction &action = mActions[ac];
+      SimpleAction::predslist::const_iterator it;
+      for(it = action.predicates.begin(); it != action.predicates.end(); it++)
+      {
+         if(it->cond != SimpleAction::None)
+            list.push_back(literal(it->pred, it->cond == SimpleAction::Set));
+      }
+   }
+
+   void SimpleActionSet::getEffects(const_iterator ac, literals &list) const
+   {
+      const SimpleAction &action = mActions[ac];
+      SimpleAction::predslist::const_iterator it;
+      for(it = action.predicates.begin(); it != action.predicates.end(); it++)
+      {
+         if(it->eff != SimpleAction::None)
+            list.push_back(literal(it->pred, it->eff == SimpleAction::Set));
+      }
+   }
+
+   bool SimpleActionSet::has(actionID ac) const
+   {
+      return ac < mActions.size();
    }
 
    bool SimpleActionSet::preMatch(const_iterator ac, const WorldState::paramlist &params, const WorldState &state) const
    {
       const SimpleAction &action = mActions[ac];
+      if(packed(action, state))
+         return maskPreMatch(action, state.valueBits(), state.careBits());
       SimpleAction::predslist::const_iterator it;
       for(it = action.predicates.begin(); it != action.predicates.end(); it++)
       {
@@ -96,7 +374,9 @@ namespace Aesop {
          if(it->cond == SimpleAction::None)
             continue;
          // Make sure that predicate is in correct state.
-         if((int)state.isSet(it->pred, WorldState::paramlist()) != it->cond)
+         if(it->cond == SimpleAction::Set
+            ? !state.isSet(it->pred, WorldState::paramlist())
+            : !state.isUnset(it->pred, WorldState::paramlist()))
             return false;
       }
       // No objections.
@@ -106,23 +386,41 @@ namespace Aesop {
    bool SimpleActionSet::postMatch(const_iterator ac, const WorldState::paramlist &params, const WorldState &state) const
    {
       const SimpleAction &action = mActions[ac];
+      if(packed(action, state))
+         return maskPostMatch(action, state.valueBits(), state.careBits());
+      bool relevant = false;
       SimpleAction::predslist::const_iterator it;
       for(it = action.predicates.begin(); it != action.predicates.end(); it++)
       {
-         // If we do not have an effect for this predicate, don't worry about it.
-         if(it->eff == SimpleAction::None)
+         // A condition we don't change must still hold after the action.
+         SimpleAction::settype want = it->eff == SimpleAction::None ? it->cond : it->eff;
+         if(want == SimpleAction::None)
             continue;
-         // Make sure that predicate is in correct state.
-         else if((int)state.isSet(it->pred, WorldState::paramlist()) != it->eff)
+         // Make sure the state doesn't need the opposite value.
+         bool has = want == SimpleAction::Set
+            ? state.isSet(it->pred, WorldState::paramlist())
+            : state.isUnset(it->pred, WorldState::paramlist());
+         bool opposite = want == SimpleAction::Set
+            ? state.isUnset(it->pred, WorldState::paramlist())
+            : state.isSet(it->pred, WorldState::paramlist());
+         if(opposite)
             return false;
+         // The action must achieve something the state asks for.
+         if(it->eff != SimpleAction::None && has)
+            relevant = true;
       }
-      // No objections.
-      return true;
+      return relevant;
    }
 
    void SimpleActionSet::applyForward(const_iterator ac, const WorldState::paramlist &params, WorldState &ns) const
    {
       const SimpleAction &action = mActions[ac];
+      if(packed(action, ns))
+      {
+         maskForward(action, ns.valueBits(), ns.careBits());
+         ns.bitsChanged();
+         return;
+      }
       SimpleAction::predslist::const_iterator it;
       for(it = action.predicates.begin(); it != action.predicates.end(); it++)
       {
@@ -136,9 +434,18 @@ namespace Aesop {
    void SimpleActionSet::applyReverse(const_iterator ac, const WorldState::paramlist &params, WorldState &ns) const
    {
       const SimpleAction &action = mActions[ac];
+      if(packed(action, ns))
+      {
+         maskReverse(action, ns.valueBits(), ns.careBits());
+         ns.bitsChanged();
+         return;
+      }
       SimpleAction::predslist::const_iterator it;
       for(it = action.predicates.begin(); it != action.predicates.end(); it++)
       {
+         // Whatever the action changes could have had any value before.
+         if(it->eff != SimpleAction::None)
+            ns.clear(it->pred, WorldState::paramlist());
          if(it->cond == SimpleAction::Set)
             ns.set(it->pred, WorldState::paramlist());
          else if(it->cond == SimpleAction::Unset)
@@ -6,6 +6,8 @@
 
 #include <vector>
 #include "abstract/AesopActionSet.h"
+#include "AesopBits.h"
+#include "AesopScratchState.h"
 
 namespace Aesop {
    /// A very simple ActionSet that does not allow actions to use parameters.
@@ -33,7 +35,8 @@ namespace Aesop {
       /// @return This object.
       SimpleActionSet &effect(Predicates::predID cond, bool set);
 
-      /// Set the cost of the action we're constructing.
+      /// Set the cost of the action we're constructing. Actions cost 1 by
+      ///        default.
       /// @param[in] cost Cost of the new action.
       /// @return This object.
       SimpleActionSet &cost(float cost);
@@ -43,20 +46,61 @@ namespace Aesop {
 
       /// @}
 
+      /// @name Action inspection
+      /// @{
+
+      /// A requirement on, or change to, the value of a single predicate.
+      struct literal {
+         /// Predicate this literal refers to.
+         Predicates::predID pred;
+         /// Whether the predicate is set or unset.
+         bool set;
+         literal(Predicates::predID p, bool s) : pred(p), set(s) {}
+      };
+
+      /// A list of literals.
+      typedef std::vector<literal> literals;
+
+      /// Supply the preconditions of an action.
+      /// @param[in]  ac   Action to inspect.
+      /// @param[out] list List to add the action's conditions to.
+      void getConditions(const_iterator ac, literals &list) const;
+
+      /// Supply the effects of an action.
+      /// @param[in]  ac   Action to inspect.
+      /// @param[out] list List to add the action's effects to.
+      void getEffects(const_iterator ac, literals &list) const;
+
+      /// Supply the actions that give a predicate a value.
+      /// @param[in]  pred Predicate to look up.
+      /// @param[in]  set  Value the actions must give the predicate.
+      /// @param[out] list List to add the actions to, in ascending order.
+      void getAchievers(Predicates::predID pred, bool set, std::vector<const_iterator> &list) const;
+
+      /// @}
+
       /// @name ActionSet
       /// @{
 
       virtual unsigned int size() const { return mActions.size(); }
 
       virtual const_iterator begin() const { return 0; }
-      virtual const_iterator end() const { return size(); }
+      virtual const_iterator end() const { return mActions.size(); }
 
-      virtual void getParamList(const_iterator it, paramcombos &list, const Objects &objects) const;
+      /// Our actions take no parameters, so each has a single empty
+      ///        parameter list.
+      virtual void getParamList(const_iterator it, paramcombos &list, const Objects &objects) const
+      {
+         list.clear();
+         list.push_back(WorldState::paramlist());
+      }
 
       virtual bool preMatch(const_iterator ac, const WorldState::paramlist &params, const WorldState &ws) const;
       virtual bool postMatch(const_iterator ac, const WorldState::paramlist &params, const WorldState &ws) const;
       virtual void applyForward(const_iterator ac, const WorldState::paramlist &params, WorldState &ns) const;
       virtual void applyReverse(const_iterator ac, const WorldState::paramlist &params, WorldState &ns) const;
+      virtual float cost(const_iterator ac, const WorldState::paramlist &params, const WorldState &ws) const { return mActions[ac].cost; }
+      virtual bool getApplicable(const WorldState &ws, bool reverse, std::vector<bitword> &result) const;
 
       bool has(actionID ac) const;
 
@@ -64,6 +108,113 @@ namespace Aesop {
 
       /// @}
 
+      /// @name Static dispatch
+      /// These do the same as getApplicable, preMatch, postMatch,
+      /// applyForward and applyReverse, but call the WorldState's packed
+      /// representation directly rather than through its virtual methods.
+      /// The state's dynamic type must be WS, as it is for the states a
+      /// solver creates.
+      /// @{
+
+      template < class WS >
+      bool getApplicableStatic(const WS &ws, bool reverse, std::vector<bitword> &result) const
+      {
+         unsigned int words = ws.WS::bitWords();
+         if(!words || words < mWords)
+            return getApplicable(ws, reverse, result);
+         return maskApplicable(ws.WS::valueBits(), ws.WS::careBits(), words, reverse, result);
+      }
+
+      template < class WS >
+      bool preMatchStatic(const_iterator ac, const WorldState::paramlist &params, const WS &ws) const
+      {
+         const SimpleAction &action = mActions[ac];
+         if(ws.WS::bitWords() >= action.words && ws.WS::bitWords() > 0)
+            return maskPreMatch(action, ws.WS::valueBits(), ws.WS::careBits());
+         return preMatch(ac, params, ws);
+      }
+
+      template < class WS >
+      bool postMatchStatic(const_iterator ac, const WorldState::paramlist &params, const WS &ws) const
+      {
+         const SimpleAction &action = mActions[ac];
+         if(ws.WS::bitWords() >= action.words && ws.WS::bitWords() > 0)
+            return maskPostMatch(action, ws.WS::valueBits(), ws.WS::careBits());
+         return postMatch(ac, params, ws);
+      }
+
+      template < class WS >
+      void applyForwardStatic(const_iterator ac, const WorldState::paramlist &params, WS &ns) const
+      {
+         const SimpleAction &action = mActions[ac];
+         if(ns.WS::bitWords() >= action.words && ns.WS::bitWords() > 0)
+         {
+            maskForward(action, ns.WS::valueBits(), ns.WS::careBits());
+            ns.WS::bitsChanged();
+         }
+         else
+            applyForward(ac, params, ns);
+      }
+
+      template < class WS >
+      void applyReverseStatic(const_iterator ac, const WorldState::paramlist &params, WS &ns) const
+      {
+         const SimpleAction &action = mActions[ac];
+         if(ns.WS::bitWords() >= action.words && ns.WS::bitWords() > 0)
+         {
+            maskReverse(action, ns.WS::valueBits(), ns.WS::careBits());
+            ns.WS::bitsChanged();
+         }
+         else
+            applyReverse(ac, params, ns);
+      }
+
+      /// Apply an action to a scratch state, recording only the packed
+      /// words it changes so that they can be undone.
+      template < class WS >
+      void applyForwardScratch(const_iterator ac, const WorldState::paramlist &params, ScratchState<WS> &scratch) const
+      {
+         const SimpleAction &action = mActions[ac];
+         WS &ns = scratch.state();
+         if(ns.WS::bitWords() >= action.words && ns.WS::bitWords() > 0)
+         {
+            SimpleAction::masklist::const_iterator m;
+            for(m = action.masks.begin(); m != action.masks.end(); m++)
+               scratch.record(m->word);
+            maskForward(action, ns.WS::valueBits(), ns.WS::careBits());
+            scratch.changed();
+         }
+         else
+         {
+            scratch.save();
+            applyForward(ac, params, ns);
+         }
+      }
+
+      /// Apply an action in reverse to a scratch state, recording only the
+      /// packed words it changes so that they can be undone.
+      template < class WS >
+      void applyReverseScratch(const_iterator ac, const WorldState::paramlist &params, ScratchState<WS> &scratch) const
+      {
+         const SimpleAction &action = mActions[ac];
+         WS &ns = scratch.state();
+         if(ns.WS::bitWords() >= action.words && ns.WS::bitWords() > 0)
+         {
+            SimpleAction::masklist::const_iterator m;
+            for(m = action.masks.begin(); m != action.masks.end(); m++)
+               scratch.record(m->word);
+            maskReverse(action, ns.WS::valueBits(), ns.WS::careBits());
+            scratch.changed();
+         }
+         else
+         {
+            scratch.save();
+            applyReverse(ac, params, ns);
+         }
+      }
+
+      /// @}
+
       /// Default constructor.
       SimpleActionSet(const Predicates &p);
 
@@ -101,10 +252,104 @@ namespace Aesop {
          /// List of instuctions about predicates.
          predslist predicates;
 
+         /// Conditions and effects on the predicates stored in one word
+         ///        of a packed WorldState.
+         struct maskword {
+            /// Word these masks apply to.
+            unsigned int word;
+            /// Predicates we have a condition on, and their required values.
+            bitword condMask, condVal;
+            /// Predicates we change, and their new values.
+            bitword effMask, effVal;
+         };
+
+         /// Store masks in ascending order of word.
+         typedef std::vector<maskword> masklist;
+         /// Predicates compiled to masks, for packed WorldStates.
+         masklist masks;
+         /// Number of words a packed WorldState must have to use our masks.
+         unsigned int words;
+
          /// Default constructor.
-         SimpleAction() : name(""), cost(0.0f) {}
+         SimpleAction() : name(""), cost(1.0f), words(0) {}
       };
 
+      /// Convert an action's list of predicates to masks.
+      /// @param action Action to compile.
+      static void compile(SimpleAction &action);
+
+      /// Do packed state bits meet an action's conditions?
+      static bool maskPreMatch(const SimpleAction &action, const bitword *value, const bitword *care)
+      {
+         SimpleAction::masklist::const_iterator m;
+         for(m = action.masks.begin(); m != action.masks.end(); m++)
+         {
+            // Every condition must be known, and have the right value.
+            if((value[m->word] & m->condMask) != m->condVal)
+               return false;
+            if(care && (care[m->word] & m->condMask) != m->condMask)
+               return false;
+         }
+         return true;
+      }
+
+      /// Could an action lead to packed state bits?
+      static bool maskPostMatch(const SimpleAction &action, const bitword *value, const bitword *care)
+      {
+         bool relevant = false;
+         SimpleAction::masklist::const_iterator m;
+         for(m = action.masks.begin(); m != action.masks.end(); m++)
+         {
+            // Values the state must have after the action: its effects, and
+            // the conditions it doesn't change.
+            bitword wantMask = m->effMask | m->condMask;
+            bitword wantVal = m->effVal | (m->condVal & ~m->effMask);
+            bitword known = care ? care[m->word] : ~(bitword)0;
+            bitword differ = value[m->word] ^ wantVal;
+            if(known & wantMask & differ)
+               return false;
+            if(known & m->effMask & ~differ)
+               relevant = true;
+         }
+         return relevant;
+      }
+
+      /// Apply an action's effects to packed state bits.
+      static void maskForward(const SimpleAction &action, bitword *value, bitword *care)
+      {
+         SimpleAction::masklist::const_iterator m;
+         for(m = action.masks.begin(); m != action.masks.end(); m++)
+         {
+            value[m->word] = (value[m->word] & ~m->effMask) | m->effVal;
+            if(care)
+               care[m->word] |= m->effMask;
+         }
+      }
+
+      /// Apply an action in reverse to packed state bits.
+      static void maskReverse(const SimpleAction &action, bitword *value, bitword *care)
+      {
+         SimpleAction::masklist::const_iterator m;
+         for(m = action.masks.begin(); m != action.masks.end(); m++)
+         {
+            // Whatever the action changes could have had any value before.
+            if(care)
+            {
+               care[m->word] = (care[m->word] & ~m->effMask) | m->condMask;
+               value[m->word] &= ~m->effMask;
+            }
+            value[m->word] = (value[m->word] & ~m->condMask) | m->condVal;
+         }
+      }
+
+      /// Can an action be matched and applied using a state's packed bits?
+      /// @param[in] action Action to check.
+      /// @param[in] ws     State the action will be used with.
+      static bool packed(const SimpleAction &action, const WorldState &ws)
+      {
+         return ws.bitWords() >= action.words && ws.bitWords() > 0;
+      }
+
       /// The action under construction.
       SimpleAction mCurrAction;
 
@@ -112,7 +357,108 @@ namespace Aesop {
       typedef std::vector<SimpleAction> actionlist;
       /// All actions that have been defined.
       actionlist mActions;
+
+      /// @name Mask table
+      /// The masks of every action, laid out word by word so that one word
+      /// of a state can be tested against several actions at once. Entry
+      /// [w * mStride + a] holds action a's masks for word w.
+      /// @{
+
+      /// Number of words the table covers.
+      unsigned int mWords;
+      /// Number of entries for each word. This is at least the number of
+      ///        actions, and entries past the last action are unused.
+      unsigned int mStride;
+      /// Conditions and their values.
+      std::vector<bitword> mCondMask, mCondVal;
+      /// Values a state must have after an action: its effects, and the
+      ///        conditions it doesn't change.
+      std::vector<bitword> mWantMask, mWantVal;
+      /// Predicates an action changes.
+      std::vector<bitword> mEffMask;
+
+      /// Bitmaps of the actions whose effects give each predicate each
+      ///        value, indexed by predicate ID times two, plus one for set.
+      std::vector<std::vector<bitword> > mAchievers;
+
+      /// Add a compiled action to the table and achiever index.
+      /// @param[in] a Position of the action in mActions.
+      void addToTable(unsigned int a);
+
+      /// Find the actions that match a packed state, as getApplicable does.
+      /// @param[in]  value   Packed predicate values of the state.
+      /// @param[in]  care    Packed care bits of the state, or NULL.
+      /// @param[in]  words   Number of packed words, at least mWords.
+      /// @param[in]  reverse Look for actions that post-match the state.
+      /// @param[out] result  Bitmap of matching actions.
+      /// @return True, since the bitmap is always exact.
+      bool maskApplicable(const bitword *value, const bitword *care, unsigned int words, bool reverse, std::vector<bitword> &result) const;
+
+      /// Does an action pre-match a packed state?
+      bool tableForward(unsigned int a, const bitword *value, const bitword *care) const;
+      /// Does an action post-match a packed state?
+      bool tableReverse(unsigned int a, const bitword *value, const bitword *care) const;
+
+      /// @}
    };
+
+   /// @name Static dispatch
+   /// SimpleActionSet overloads that avoid virtual calls.
+   /// @{
+
+   /// @ingroup Aesop
+   inline ActionSet::const_iterator ActionsBegin(const SimpleActionSet &actions)
+   { return actions.SimpleActionSet::begin(); }
+
+   /// @ingroup Aesop
+   inline ActionSet::const_iterator ActionsEnd(const SimpleActionSet &actions)
+   { return actions.SimpleActionSet::end(); }
+
+   /// @ingroup Aesop
+   inline void GetParamList(const SimpleActionSet &actions, ActionSet::const_iterator ac, ActionSet::paramcombos &list, const Objects &objects)
+   { actions.SimpleActionSet::getParamList(ac, list, objects); }
+
+   /// @ingroup Aesop
+   template < class WS >
+   bool GetApplicable(const SimpleActionSet &actions, const WS &ws, bool reverse, std::vector<bitword> &result)
+   { return actions.getApplicableStatic(ws, reverse, result); }
+
+   /// @ingroup Aesop
+   template < class WS >
+   bool PreMatch(const SimpleActionSet &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, const WS &ws)
+   { return actions.preMatchStatic(ac, params, ws); }
+
+   /// @ingroup Aesop
+   template < class WS >
+   bool PostMatch(const SimpleActionSet &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, const WS &ws)
+   { return actions.postMatchStatic(ac, params, ws); }
+
+   /// @ingroup Aesop
+   template < class WS >
+   void ApplyForward(const SimpleActionSet &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, WS &ns)
+   { actions.applyForwardStatic(ac, params, ns); }
+
+   /// @ingroup Aesop
+   template < class WS >
+   void ApplyReverse(const SimpleActionSet &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, WS &ns)
+   { actions.applyReverseStatic(ac, params, ns); }
+
+   /// @ingroup Aesop
+   template < class WS >
+   void ApplyForwardScratch(const SimpleActionSet &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, ScratchState<WS> &scratch)
+   { actions.applyForwardScratch(ac, params, scratch); }
+
+   /// @ingroup Aesop
+   template < class WS >
+   void ApplyReverseScratch(const SimpleActionSet &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, ScratchState<WS> &scratch)
+   { actions.applyReverseScratch(ac, params, scratch); }
+
+   /// @ingroup Aesop
+   template < class WS >
+   float ActionCost(const SimpleActionSet &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, const WS &ws)
+   { return actions.SimpleActionSet::cost(ac, params, ws); }
+
+   /// @}
 };
 
 #endif
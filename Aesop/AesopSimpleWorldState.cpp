@@ -11,8 +11,9 @@ namespace Aesop {
 
    SimpleWorldState::SimpleWorldState(const Predicates &p) : WorldState(p)
    {
-      mHash = 0;
-      mState.resize(getPredicates().size());
+      mSize = getPredicates().size();
+      mState.resize(wordCount(mSize));
+      updateHash();
    }
 
    SimpleWorldState::~SimpleWorldState()
@@ -21,35 +22,37 @@ namespace Aesop {
 
    bool SimpleWorldState::isSet(Predicates::predID pred, const paramlist &params) const
    {
-      return pred < mState.size() && mState[pred].set;
+      return pred < mSize && (mState[wordIndex(pred)] & bitMask(pred)) != 0;
    }
 
    void SimpleWorldState::set(Predicates::predID pred, const paramlist &params)
    {
-      if(pred < mState.size())
+      if(pred < mSize)
       {
+         bitword old = mState[wordIndex(pred)];
          _set(pred, params);
-         updateHash();
+         SimpleWorldState::rehashWord(wordIndex(pred), old, 0);
       }
    }
 
    void SimpleWorldState::_set(Predicates::predID pred, const paramlist &params)
    {
-      mState[pred].set = true;
+      mState[wordIndex(pred)] |= bitMask(pred);
    }
 
    void SimpleWorldState::unset(Predicates::predID pred, const paramlist &params)
    {
-      if(pred < mState.size())
+      if(pred < mSize)
       {
+         bitword old = mState[wordIndex(pred)];
          _unset(pred, params);
-         updateHash();
+         SimpleWorldState::rehashWord(wordIndex(pred), old, 0);
       }
    }
 
    void SimpleWorldState::_unset(Predicates::predID pred, const paramlist &params)
    {
-      mState[pred].set = false;
+      mState[wordIndex(pred)] &= ~bitMask(pred);
    }
 
    WorldState *SimpleWorldState::clone() const
@@ -60,11 +63,10 @@ namespace Aesop {
    std::string SimpleWorldState::repr() const
    {
       std::string str = "{";
-      worldrep::const_iterator it = mState.begin();
-      while(it != mState.end())
+      for(unsigned int p = 0; p < mSize; p++)
       {
-         str += it->set ? "t" : "f";
-         if(++it != mState.end())
+         str += isSet(p) ? "t" : "f";
+         if(p + 1 < mSize)
             str += ", ";
       }
       str += "}";
@@ -74,24 +76,16 @@ namespace Aesop {
    unsigned int SimpleWorldState::compare(const SimpleWorldState &other) const
    {
       unsigned int diff = 0;
-      worldrep::const_iterator it;
-      worldrep::const_iterator oit;
-      for(it = mState.begin(), oit = other.mState.begin();
-          it != mState.end() && oit != other.mState.end();
-          it++, oit++)
-      {
-         if(it->set != oit->set)
-            diff++;
-      }
+      unsigned int n = mState.size() < other.mState.size() ? mState.size() : other.mState.size();
+      for(unsigned int i = 0; i < n; i++)
+         diff += popcount(mState[i] ^ other.mState[i]);
       return diff;
    }
 
    void SimpleWorldState::updateHash()
    {
-      mHash = mState.size();
-      worldrep::const_iterator it;
-      unsigned int i;
-      for(it = mState.begin(), i = 0; it != mState.end(); it++, i++)
-         mHash ^= it->set ? i : 0;
+      mHash = 0;
+      for(unsigned int i = 0; i < mState.size(); i++)
+         mHash ^= zobristBits(i, mState[i], 1);
    }
 };
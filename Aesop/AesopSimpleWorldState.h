@@ -6,9 +6,14 @@
 
 #include <vector>
 #include "abstract/AesopWorldState.h"
+#include "AesopBits.h"
 
 namespace Aesop {
    /// Simplest WorldState implementation.
+   ///
+   /// Predicate values are packed 64 to a word, so comparing and hashing
+   /// states works on whole words at a time.
+   ///
    /// @ingroup Aesop
    class SimpleWorldState : public WorldState {
    public:
@@ -27,14 +32,21 @@ namespace Aesop {
 
       virtual bool operator==(const SimpleWorldState &other) const
       {
-         return mHash != other.mHash ? false : compare(other) == 0;
+         return mHash == other.mHash && mState == other.mState;
       }
 
       virtual bool operator!=(const SimpleWorldState &other) const
       {
-         return mHash != other.mHash ? true : compare(other) != 0;
+         return !operator==(other);
       }
 
+      virtual unsigned int bitWords() const { return mState.size(); }
+      virtual const bitword *valueBits() const { return mState.data(); }
+      virtual bitword *valueBits() { return mState.data(); }
+      virtual void bitsChanged() { updateHash(); }
+      virtual void rehashWord(unsigned int word, bitword oldValue, bitword oldCare)
+      { mHash ^= zobristBits(word, oldValue ^ mState[word], 1); }
+
       /// @}
 
       SimpleWorldState(const Predicates &p);
@@ -49,19 +61,14 @@ namespace Aesop {
       /// @see WorldState::unset
       void _unset(Predicates::predID pred, const paramlist &params);
 
-      /// Hashed representation of this state, used for quick comparison.
-      int mHash;
-      /// Update our hash value.
+      /// Recompute our hash value from scratch.
       void updateHash();
 
-      /// Store a fact about the world.
-      struct fact {
-         /// Is this predicate set?
-         bool set;
-         fact() : set(false) {}
-      };
-      /// Our world representation is simply a list of facts.
-      typedef std::vector<fact> worldrep;
+      /// Number of predicates we store.
+      unsigned int mSize;
+      /// Our world representation is a packed array of predicate values.
+      ///        Bits beyond the last predicate are always zero.
+      typedef std::vector<bitword> worldrep;
       /// Stores representation of world state.
       worldrep mState;
    };
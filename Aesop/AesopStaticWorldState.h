@@ -0,0 +1,136 @@
+/// @file AesopStaticWorldState.h
+/// Definition of StaticWorldState class template.
+
+#ifndef _AE_STATIC_WORLDSTATE_H_
+#define _AE_STATIC_WORLDSTATE_H_
+
+#include <array>
+#include "abstract/AesopWorldState.h"
+#include "AesopBits.h"
+
+namespace Aesop {
+   /// WorldState of boolean predicates with a size fixed at compile time.
+   ///
+   /// Behaves like SimpleWorldState, but stores its packed predicate values
+   /// in an array inside the object rather than on the heap. Copying a state
+   /// therefore never allocates, and a state can be stored by value in any
+   /// container of nodes.
+   ///
+   /// @tparam NumPreds Number of predicates the state can hold. Predicates
+   ///                  with higher IDs are never set.
+   /// @ingroup Aesop
+   template < unsigned int NumPreds >
+   class StaticWorldState : public WorldState {
+   public:
+      /// Number of words needed to store the predicates.
+      static constexpr unsigned int words = (NumPreds + wordBits - 1) / wordBits;
+
+      /// Word that holds a predicate.
+      static constexpr unsigned int word(Predicates::predID pred)
+      { return pred / wordBits; }
+
+      /// Mask that selects a predicate within its word.
+      static constexpr bitword mask(Predicates::predID pred)
+      { return (bitword)1 << (pred % wordBits); }
+
+      /// @name WorldState
+      /// @{
+
+      virtual bool isSet(Predicates::predID pred, const paramlist &params = paramlist()) const
+      {
+         return pred < NumPreds && (mState[word(pred)] & mask(pred)) != 0;
+      }
+
+      virtual bool isUnset(Predicates::predID pred, const paramlist &params = paramlist()) const
+      { return !isSet(pred, params); }
+
+      virtual void set(Predicates::predID pred, const paramlist &params = paramlist())
+      {
+         if(pred < NumPreds)
+         {
+            bitword old = mState[word(pred)];
+            mState[word(pred)] |= mask(pred);
+            StaticWorldState::rehashWord(word(pred), old, 0);
+         }
+      }
+
+      virtual void unset(Predicates::predID pred, const paramlist &params = paramlist())
+      {
+         if(pred < NumPreds)
+         {
+            bitword old = mState[word(pred)];
+            mState[word(pred)] &= ~mask(pred);
+            StaticWorldState::rehashWord(word(pred), old, 0);
+         }
+      }
+
+      virtual WorldState *clone() const
+      {
+         return new StaticWorldState(*this);
+      }
+
+      virtual std::string repr() const
+      {
+         std::string str = "{";
+         for(unsigned int p = 0; p < NumPreds; p++)
+         {
+            str += isSet(p) ? "t" : "f";
+            if(p + 1 < NumPreds)
+               str += ", ";
+         }
+         str += "}";
+         return str;
+      }
+
+      unsigned int compare(const StaticWorldState &other) const
+      {
+         unsigned int diff = 0;
+         for(unsigned int i = 0; i < words; i++)
+            diff += popcount(mState[i] ^ other.mState[i]);
+         return diff;
+      }
+
+      virtual bool operator==(const StaticWorldState &other) const
+      {
+         return mHash == other.mHash && mState == other.mState;
+      }
+
+      virtual bool operator!=(const StaticWorldState &other) const
+      {
+         return !operator==(other);
+      }
+
+      virtual unsigned int bitWords() const { return words; }
+      virtual const bitword *valueBits() const { return mState.data(); }
+      virtual bitword *valueBits() { return mState.data(); }
+      virtual void bitsChanged() { updateHash(); }
+      virtual void rehashWord(unsigned int word, bitword oldValue, bitword oldCare)
+      { mHash ^= zobristBits(word, oldValue ^ mState[word], 1); }
+
+      /// @}
+
+      StaticWorldState(const Predicates &p) : WorldState(p)
+      {
+         mState.fill(0);
+         updateHash();
+      }
+
+   protected:
+   private:
+      /// Recompute our hash value from scratch.
+      void updateHash()
+      {
+         mHash = 0;
+         for(unsigned int i = 0; i < words; i++)
+            mHash ^= zobristBits(i, mState[i], 1);
+      }
+
+      /// Packed array of predicate values, stored in place.
+      std::array<bitword, words> mState;
+   };
+
+   template < unsigned int NumPreds >
+   constexpr unsigned int StaticWorldState<NumPreds>::words;
+};
+
+#endif
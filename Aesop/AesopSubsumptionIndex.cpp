@@ -0,0 +1,113 @@
+/// @file AesopSubsumptionIndex.cpp
+/// Implementation of SubsumptionIndex class as defined in AesopSubsumptionIndex.h
+
+#include "AesopSubsumptionIndex.h"
+
+namespace Aesop {
+   SubsumptionIndex::SubsumptionIndex()
+   {
+      clear();
+   }
+
+   void SubsumptionIndex::clear()
+   {
+      node root = {0, 0, 0, false, 0.0f, std::numeric_limits<float>::infinity()};
+      mNodes.assign(1, root);
+      mSize = 0;
+   }
+
+   void SubsumptionIndex::insert(const literals &set, float cost)
+   {
+      unsigned int n = 0;
+      literals::const_iterator l;
+      for(l = set.begin(); l != set.end(); l++)
+      {
+         if(cost < mNodes[n].best)
+            mNodes[n].best = cost;
+         // Find the child for this literal, or where it should go.
+         unsigned int prev = 0;
+         unsigned int c = mNodes[n].child;
+         while(c && mNodes[c].literal < *l)
+         {
+            prev = c;
+            c = mNodes[c].sibling;
+         }
+         if(!c || mNodes[c].literal != *l)
+         {
+            node child = {*l, 0, c, false, cost, cost};
+            unsigned int i = mNodes.size();
+            mNodes.push_back(child);
+            if(prev)
+               mNodes[prev].sibling = i;
+            else
+               mNodes[n].child = i;
+            c = i;
+         }
+         n = c;
+      }
+      if(cost < mNodes[n].best)
+         mNodes[n].best = cost;
+      if(!mNodes[n].end)
+      {
+         mNodes[n].end = true;
+         mNodes[n].cost = cost;
+         mSize++;
+      }
+      else if(cost < mNodes[n].cost)
+         mNodes[n].cost = cost;
+   }
+
+   bool SubsumptionIndex::subsumed(const literals &set, float cost) const
+   {
+      if(mNodes[0].best > cost)
+         return false;
+      return (mNodes[0].end && mNodes[0].cost <= cost) || search(0, set, 0, cost);
+   }
+
+   bool SubsumptionIndex::subsumes(const literals &set) const
+   {
+      return mSize && searchSuperset(0, set, 0);
+   }
+
+   bool SubsumptionIndex::search(unsigned int n, const literals &set, unsigned int pos, float cost) const
+   {
+      // Children and query are both ascending, so walk them together and
+      // only descend along literals the query contains.
+      unsigned int c = mNodes[n].child;
+      while(c && pos < set.size())
+      {
+         if(mNodes[c].literal < set[pos])
+            c = mNodes[c].sibling;
+         else if(mNodes[c].literal > set[pos])
+            pos++;
+         else
+         {
+            // Skip branches where every stored set costs too much.
+            if(mNodes[c].best <= cost &&
+               ((mNodes[c].end && mNodes[c].cost <= cost) || search(c, set, pos + 1, cost)))
+               return true;
+            c = mNodes[c].sibling;
+            pos++;
+         }
+      }
+      return false;
+   }
+
+   bool SubsumptionIndex::searchSuperset(unsigned int n, const literals &set, unsigned int pos) const
+   {
+      // Every node lies on the path of a stored set, so once the whole
+      // query has been found, a superset ends somewhere below.
+      if(pos == set.size())
+         return true;
+      // Children are ascending, and a path can't come back to a literal it
+      // has passed, so only children up to the next query literal can lead
+      // to a superset.
+      unsigned int c;
+      for(c = mNodes[n].child; c && mNodes[c].literal <= set[pos]; c = mNodes[c].sibling)
+      {
+         if(searchSuperset(c, set, mNodes[c].literal == set[pos] ? pos + 1 : pos))
+            return true;
+      }
+      return false;
+   }
+};
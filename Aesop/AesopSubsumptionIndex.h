@@ -0,0 +1,113 @@
+/// @file AesopSubsumptionIndex.h
+/// Definition of SubsumptionIndex class.
+
+#ifndef _AE_SUBSUMPTION_INDEX_H_
+#define _AE_SUBSUMPTION_INDEX_H_
+
+#include <vector>
+#include <limits>
+
+namespace Aesop {
+   /// Set trie that answers whether any stored set of literals is a subset
+   /// of a query set, or a superset of one.
+   ///
+   /// A partial world state can be written as the set of literals it asks
+   /// for, where a literal is a predicate together with its value. One state
+   /// subsumes another when its literals are a subset of the other's. The
+   /// index stores each set as a path of ascending literals through a trie,
+   /// so a query only visits the branches whose literals it contains, rather
+   /// than every stored set.
+   ///
+   /// Each set is stored with a cost, and a query only counts stored sets
+   /// that cost no more than it does. A search can then prune a state only
+   /// when a more general one has been reached at least as cheaply. Every
+   /// node keeps the lowest cost stored beneath it, so branches that are
+   /// too expensive are skipped whole.
+   ///
+   /// @ingroup Aesop
+   class SubsumptionIndex {
+   public:
+      /// A set of literals in strictly ascending order.
+      typedef std::vector<unsigned int> literals;
+
+      /// Add a set to the index. A set added more than once keeps its
+      ///        lowest cost.
+      /// @param[in] set  Literals in ascending order.
+      /// @param[in] cost Cost to store with the set.
+      void insert(const literals &set, float cost = 0.0f);
+
+      /// Is any stored set a subset of a query, at no greater cost?
+      /// @param[in] set  Literals in ascending order.
+      /// @param[in] cost Cost of the query.
+      /// @return True iff some stored set with a cost no more than the
+      ///         query's contains only literals in the query.
+      bool subsumed(const literals &set, float cost = std::numeric_limits<float>::infinity()) const;
+
+      /// Is a query a subset of any stored set, whatever its cost?
+      /// @param[in] set Literals in ascending order.
+      /// @return True iff some stored set contains every literal in the
+      ///         query.
+      bool subsumes(const literals &set) const;
+
+      /// Remove all sets.
+      void clear();
+
+      /// Number of sets stored.
+      unsigned int size() const { return mSize; }
+
+      /// Default constructor.
+      SubsumptionIndex();
+
+   protected:
+   private:
+      /// A node in the trie, with its children linked as a list of siblings
+      ///        in ascending order of literal.
+      struct node {
+         /// Literal on the edge that leads to this node.
+         unsigned int literal;
+         /// First child, or 0 if there are none.
+         unsigned int child;
+         /// Next sibling, or 0 if there is none.
+         unsigned int sibling;
+         /// Does a stored set end here?
+         bool end;
+         /// Cost of the set that ends here.
+         float cost;
+         /// Lowest cost of any set that ends here or below.
+         float best;
+      };
+
+      /// All nodes of the trie. The root is always the first.
+      std::vector<node> mNodes;
+      /// Number of sets stored.
+      unsigned int mSize;
+
+      /// Search the subtree under a node for a subset of a query.
+      /// @param[in] n    Node to search under.
+      /// @param[in] set  Query literals.
+      /// @param[in] pos  First literal of the query not yet used on this path.
+      /// @param[in] cost Cost of the query.
+      bool search(unsigned int n, const literals &set, unsigned int pos, float cost) const;
+
+      /// Search the subtree under a node for a superset of a query.
+      /// @param[in] n   Node to search under.
+      /// @param[in] set Query literals.
+      /// @param[in] pos First literal of the query not yet found on this path.
+      bool searchSuperset(unsigned int n, const literals &set, unsigned int pos) const;
+   };
+
+   /// Get the literals a world state asks for, if its type can be indexed
+   /// for subsumption. WorldStates that always know the value of every
+   /// predicate can't usefully be, so by default this does nothing.
+   /// @param[in]  ws  State to describe.
+   /// @param[out] set Ascending literals the state asks for.
+   /// @return True iff the state's literals were written.
+   /// @ingroup Aesop
+   template < class WS >
+   bool StateLiterals(const WS &ws, SubsumptionIndex::literals &set)
+   {
+      return false;
+   }
+};
+
+#endif
@@ -78,6 +78,30 @@ namespace Aesop {
       /// @param[in] ws     WorldState to apply changes to.
       virtual void applyReverse(const_iterator ac, const WorldState::paramlist &params, WorldState &ns) const = 0;
 
+      /// Get the cost of performing an action.
+      /// @param[in] ac     Action to get the cost of.
+      /// @param[in] params Parameters to the action.
+      /// @param[in] ws     WorldState the action would be performed in.
+      /// @return Cost of the action, which must not be negative. Every action
+      ///         costs 1 unless this method is overridden.
+      virtual float cost(const_iterator ac, const WorldState::paramlist &params, const WorldState &ws) const { return 1.0f; }
+
+      /// Find every action that could be used in a WorldState at once.
+      ///        Unless overridden, this marks every action as a candidate.
+      /// @param[in]  ws      WorldState to check actions against.
+      /// @param[in]  reverse Look for actions that post-match the state,
+      ///                     rather than ones that pre-match it.
+      /// @param[out] result  Bitmap indexed by const_iterator. Actions whose
+      ///                     bits are clear never match the state.
+      /// @return True if the bitmap is exact: every action whose bit is set
+      ///         matches the state with all of its parameter combinations,
+      ///         so preMatch or postMatch needn't be called.
+      virtual bool getApplicable(const WorldState &ws, bool reverse, std::vector<bitword> &result) const
+      {
+         result.assign(wordCount(end()), ~(bitword)0);
+         return false;
+      }
+
       /// @}
 
       /// Return a string representation of the given action.
@@ -102,6 +126,71 @@ namespace Aesop {
       /// Predicates to validate Action parameters.
       const Predicates &mPredicates;
    };
+
+   /// @name Static dispatch
+   /// Solvers use an ActionSet through these functions. They are templated
+   /// on the static types of the ActionSet and WorldState, and by default
+   /// call the ActionSet's virtual methods. An ActionSet may overload them
+   /// for its own type to match and apply actions without virtual calls.
+   /// Overloads are chosen by static type, so a subclass that overrides the
+   /// virtual methods should be passed to the solvers as its own type.
+   /// @{
+
+   /// @see ActionSet::begin
+   /// @ingroup Aesop
+   template < class AS >
+   ActionSet::const_iterator ActionsBegin(const AS &actions)
+   { return actions.begin(); }
+
+   /// @see ActionSet::end
+   /// @ingroup Aesop
+   template < class AS >
+   ActionSet::const_iterator ActionsEnd(const AS &actions)
+   { return actions.end(); }
+
+   /// @see ActionSet::getParamList
+   /// @ingroup Aesop
+   template < class AS >
+   void GetParamList(const AS &actions, ActionSet::const_iterator ac, ActionSet::paramcombos &list, const Objects &objects)
+   { actions.getParamList(ac, list, objects); }
+
+   /// @see ActionSet::getApplicable
+   /// @ingroup Aesop
+   template < class AS, class WS >
+   bool GetApplicable(const AS &actions, const WS &ws, bool reverse, std::vector<bitword> &result)
+   { return actions.getApplicable(ws, reverse, result); }
+
+   /// @see ActionSet::preMatch
+   /// @ingroup Aesop
+   template < class AS, class WS >
+   bool PreMatch(const AS &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, const WS &ws)
+   { return actions.preMatch(ac, params, ws); }
+
+   /// @see ActionSet::postMatch
+   /// @ingroup Aesop
+   template < class AS, class WS >
+   bool PostMatch(const AS &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, const WS &ws)
+   { return actions.postMatch(ac, params, ws); }
+
+   /// @see ActionSet::applyForward
+   /// @ingroup Aesop
+   template < class AS, class WS >
+   void ApplyForward(const AS &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, WS &ns)
+   { actions.applyForward(ac, params, ns); }
+
+   /// @see ActionSet::applyReverse
+   /// @ingroup Aesop
+   template < class AS, class WS >
+   void ApplyReverse(const AS &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, WS &ns)
+   { actions.applyReverse(ac, params, ns); }
+
+   /// @see ActionSet::cost
+   /// @ingroup Aesop
+   template < class AS, class WS >
+   float ActionCost(const AS &actions, ActionSet::const_iterator ac, const WorldState::paramlist &params, const WS &ws)
+   { return actions.cost(ac, params, ws); }
+
+   /// @}
 };
 
 #endif
@@ -16,6 +16,9 @@ namespace Aesop {
       virtual void success() = 0;
       virtual void failure() = 0;
       virtual void toClosed(unsigned int ID) = 0;
+      /// A memory-bounded search forgot a state. Contexts that don't
+      ///        care needn't override this.
+      virtual void forgotten(unsigned int ID) {}
       //virtual void newState(const Problem::openstate &s) = 0;
       virtual void beginPlanning() = 0;
       virtual void beginIteration() = 0;
@@ -31,6 +34,7 @@ namespace Aesop {
       virtual void success() {}
       virtual void failure() {}
       virtual void toClosed(unsigned int ID) {}
+      virtual void forgotten(unsigned int ID) {}
       //virtual void newState(const Problem::openstate &s) {}
       virtual void beginPlanning() {}
       virtual void beginIteration() {}
@@ -8,6 +8,7 @@
 #include <string>
 #include "AesopPredicates.h"
 #include "AesopObjects.h"
+#include "../AesopBits.h"
 
 namespace Aesop {
    /// Knowledge about a state of the world, current or possible.
@@ -46,6 +47,13 @@ namespace Aesop {
       /// @param[in] params Map of parameter names to values to check.
       virtual void unset(Predicates::predID pred, const paramlist &params) = 0;
 
+      /// Stop caring about the value of a predicate, so that it is neither
+      ///        set nor unset. WorldStates that always know the value of every
+      ///        predicate ignore this.
+      /// @param[in] pred   Name of the predicate to forget.
+      /// @param[in] params Map of parameter names to values to check.
+      virtual void clear(Predicates::predID pred, const paramlist &params) {}
+
       /// Make a copy of this WorldState.
       /// @return A pointer to a new WorldState of the same class as this one,
       ///         initialised to the same value.
@@ -55,19 +63,80 @@ namespace Aesop {
       /// @return A string representing this state.
       virtual std::string repr() const = 0;
 
+      /// @name Packed representation
+      /// WorldStates that store simple predicates as packed bits may expose
+      /// them, so that ActionSets can test and apply whole words at once.
+      /// A WorldState that doesn't is accessed through the methods above.
+      /// @{
+
+      /// Get the number of words of packed predicate values.
+      /// @return Number of words, or 0 if this state isn't packed.
+      virtual unsigned int bitWords() const { return 0; }
+
+      /// Get the packed predicate values. Predicate p is stored in word
+      ///        wordIndex(p) under bitMask(p).
+      virtual const bitword *valueBits() const { return NULL; }
+      virtual bitword *valueBits() { return NULL; }
+
+      /// Get the packed bits that say which predicates have a known value.
+      /// @return Care bits, or NULL if every predicate is always known.
+      virtual const bitword *careBits() const { return NULL; }
+      virtual bitword *careBits() { return NULL; }
+
+      /// Must be called after changing the packed bits directly.
+      virtual void bitsChanged() {}
+
+      /// May be called instead of bitsChanged when only one word was
+      ///        changed, to update the hash in time proportional to the
+      ///        number of predicates that changed.
+      /// @param[in] word     Index of the word that changed.
+      /// @param[in] oldValue Previous contents of the value word.
+      /// @param[in] oldCare  Previous contents of the care word, if any.
+      virtual void rehashWord(unsigned int word, bitword oldValue, bitword oldCare) { bitsChanged(); }
+
+      /// @}
+
       /// Get the Predicates object used by this WorldState.
       /// @return A Predicates object.
-      const Predicates &getPredicates() const { return mPredicates; }
+      const Predicates &getPredicates() const { return *mPredicates; }
+
+      /// Get a hash of this state's value.
+      /// @return Hash value that is equal for all equal states. Derived
+      ///         classes keep it up to date as predicates change.
+      statehash hash() const { return mHash; }
 
       /// Default constructor.
       /// @param[in] p Predicates object to validate our state.
-      WorldState(const Predicates &p) : mPredicates(p) {}
+      WorldState(const Predicates &p) : mHash(0), mPredicates(&p) {}
+
+      /// Default destructor.
+      virtual ~WorldState() {}
 
    protected:
+      /// Hash of this state's value. Usually built from the zobristKey of
+      ///        each predicate value held, so that it can be updated as
+      ///        each predicate changes.
+      statehash mHash;
+
    private:
-      /// Handle to our Predicates object.
-      const Predicates &mPredicates;
+      /// Handle to our Predicates object. Stored as a pointer so that
+      ///        WorldStates can be assigned to each other.
+      const Predicates *mPredicates;
    };
+
+   /// Does a state satisfy everything a target state asks for? By default
+   /// this means the two are equal, compared with WS's own operator== so
+   /// that the call needn't be virtual. WorldStates that leave some
+   /// predicates unknown overload this function.
+   /// @param[in] state  State that has been reached.
+   /// @param[in] target State that is wanted.
+   /// @return True iff the state satisfies the target.
+   /// @ingroup Aesop
+   template < class WS >
+   bool ReachedGoal(const WS &state, const WS &target)
+   {
+      return state.WS::operator==(target);
+   }
 };
 
 #endif
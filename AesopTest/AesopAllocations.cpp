@@ -0,0 +1,32 @@
+/// @file AesopAllocations.cpp
+/// Replacement global allocation functions that count allocations, for
+/// tests in AesopAllocationTest.h. Kept in a file of their own so that the
+/// compiler can't see them when checking how the tests use new and delete.
+
+#include <cstdlib>
+#include <new>
+
+/// Should allocations be counted?
+bool gCountAllocations = false;
+/// Number of allocations made while counting.
+unsigned int gAllocations = 0;
+
+void *operator new(std::size_t size)
+{
+   if(gCountAllocations)
+      gAllocations++;
+   void *p = std::malloc(size ? size : 1);
+   if(!p)
+      throw std::bad_alloc();
+   return p;
+}
+
+void operator delete(void *p) noexcept
+{
+   std::free(p);
+}
+
+void operator delete(void *p, std::size_t size) noexcept
+{
+   std::free(p);
+}
@@ -0,0 +1,12 @@
+/// @file AesopTest.h
+/// Test cases included by the AesopTest module.
+
+#include "tests/AesopHashIndexTest.h"
+#include "tests/AesopSubsumptionIndexTest.h"
+#include "tests/AesopArenaTest.h"
+#include "tests/AesopSimpleWorldStateTest.h"
+#include "tests/AesopMaskedWorldStateTest.h"
+#include "tests/AesopStaticWorldStateTest.h"
+#include "tests/AesopGOAPWorldStateTest.h"
+#include "tests/AesopPlannerTest.h"
+#include "tests/AesopAllocationTest.h"
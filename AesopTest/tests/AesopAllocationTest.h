@@ -0,0 +1,55 @@
+/// @file AesopAllocationTest.h
+/// gtest cases that count the memory allocated while planning.
+
+#include "gtest/gtest.h"
+#include "AesopReverseAstar.h"
+#include "AesopForwardAstar.h"
+
+/// Should allocations be counted? Defined in AesopAllocations.cpp.
+extern bool gCountAllocations;
+/// Number of allocations made while counting.
+extern unsigned int gAllocations;
+
+TEST_F(PlannerTest, NoAllocationAfterWarmUp)
+{
+   Plan plan;
+   // The first searches size this thread's workspace and the plan.
+   ASSERT_TRUE(ReverseAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   plan.clear();
+   ASSERT_TRUE(ForwardAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+
+   gAllocations = 0;
+   gCountAllocations = true;
+   bool solved = true;
+   for(unsigned int i = 0; i < 100; i++)
+   {
+      plan.clear();
+      solved = ReverseAstarSolve(init, goal, actions, NoObjects, plan, ctx) && solved;
+      plan.clear();
+      solved = ForwardAstarSolve(init, goal, actions, NoObjects, plan, ctx) && solved;
+   }
+   gCountAllocations = false;
+
+   EXPECT_TRUE(solved);
+   EXPECT_EQ(gAllocations, 0u);
+   EXPECT_EQ(length(plan), 4u);
+}
+
+TEST_F(PlannerTest, ThreadProblem)
+{
+   // Each thread has one workspace per WorldState and heuristic type.
+   Problem<SimpleWorldState> &a = ThreadProblem<SimpleWorldState>(GoalCountHeuristic());
+   Problem<SimpleWorldState> &b = ThreadProblem<SimpleWorldState>(GoalCountHeuristic());
+   EXPECT_EQ(&a, &b);
+   // A workspace that has been used gives the same results as a new one.
+   Plan plan, fresh;
+   ASSERT_TRUE(ReverseAstarInit(init, goal, a, ctx));
+   while(ReverseAstarIteration(a, actions, NoObjects, ctx)) {}
+   ReverseAstarFinalise(a, plan, ctx);
+   Problem<SimpleWorldState> prob;
+   ASSERT_TRUE(ReverseAstarInit(init, goal, prob, ctx));
+   while(ReverseAstarIteration(prob, actions, NoObjects, ctx)) {}
+   ReverseAstarFinalise(prob, fresh, ctx);
+   EXPECT_TRUE(samePlan(plan, fresh));
+   EXPECT_EQ(a.closed.size(), prob.closed.size());
+}
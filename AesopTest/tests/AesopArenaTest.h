@@ -0,0 +1,96 @@
+/// @file AesopArenaTest.h
+/// gtest cases for Arena class template.
+
+#include "gtest/gtest.h"
+#include "AesopArena.h"
+
+using namespace Aesop;
+
+/// Counts the live copies of itself, to check that an Arena destroys what
+/// it stores.
+/// @ingroup AesopTest
+struct Counted {
+   static int live;
+   int value;
+   Counted(int v) : value(v) { live++; }
+   Counted(const Counted &other) : value(other.value) { live++; }
+   Counted &operator=(const Counted &other) { value = other.value; return *this; }
+   ~Counted() { live--; }
+};
+
+int Counted::live = 0;
+
+/// Test fixture for the Arena class template. Uses small blocks so that
+/// tests cross block boundaries.
+/// @ingroup AesopTest
+class ArenaTest : public ::testing::Test {
+protected:
+   typedef Arena<Counted, 2> arena;
+
+   ArenaTest()
+   {
+      Counted::live = 0;
+   }
+};
+
+TEST_F(ArenaTest, Add)
+{
+   arena a;
+   EXPECT_EQ(a.size(), 0u);
+   std::vector<Counted*> added;
+   for(int i = 0; i < 10; i++)
+   {
+      EXPECT_EQ(a.add(Counted(i)), (unsigned int)i);
+      added.push_back(&a[i]);
+   }
+   EXPECT_EQ(a.size(), 10u);
+   EXPECT_EQ(Counted::live, 10);
+   // Objects keep their values and never move.
+   for(int i = 0; i < 10; i++)
+   {
+      EXPECT_EQ(a[i].value, i);
+      EXPECT_EQ(&a[i], added[i]);
+   }
+}
+
+TEST_F(ArenaTest, Clear)
+{
+   {
+      arena a;
+      for(int i = 0; i < 10; i++)
+         a.add(Counted(i));
+      Counted *first = &a[0];
+      a.clear();
+      EXPECT_EQ(a.size(), 0u);
+      EXPECT_EQ(Counted::live, 0);
+      // Memory is reused after clearing.
+      a.add(Counted(5));
+      EXPECT_EQ(&a[0], first);
+      EXPECT_EQ(a[0].value, 5);
+   }
+   // The destructor destroys what is left.
+   EXPECT_EQ(Counted::live, 0);
+}
+
+TEST_F(ArenaTest, Reset)
+{
+   arena a;
+   for(int i = 0; i < 10; i++)
+      a.add(Counted(i));
+   Counted *first = &a[0];
+   // Resetting keeps the objects alive for reuse.
+   a.reset();
+   EXPECT_EQ(a.size(), 0u);
+   EXPECT_EQ(Counted::live, 10);
+   // New objects are assigned over the old ones.
+   EXPECT_EQ(a.add(Counted(20)), 0u);
+   EXPECT_EQ(&a[0], first);
+   EXPECT_EQ(a[0].value, 20);
+   EXPECT_EQ(Counted::live, 10);
+   // Adding beyond the old objects constructs new ones.
+   for(int i = 1; i < 12; i++)
+      a.add(Counted(i));
+   EXPECT_EQ(Counted::live, 12);
+   a.clear();
+   EXPECT_EQ(Counted::live, 0);
+}
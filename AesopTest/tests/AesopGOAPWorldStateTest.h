@@ -0,0 +1,50 @@
+/// @file AesopGOAPWorldStateTest.h
+/// gtest cases for GOAPWorldState class.
+
+#include "gtest/gtest.h"
+#include "AesopSimplePredicates.h"
+#include "AesopGOAPWorldState.h"
+
+using namespace Aesop;
+
+/// Test fixture for the GOAPWorldState class.
+/// @ingroup AesopTest
+class GOAPWorldStateTest : public ::testing::Test {
+protected:
+   SimplePredicates preds;
+   GOAPWorldState ws1;
+   GOAPWorldState ws2;
+
+   GOAPWorldStateTest()
+      : ws1((preds.define(10), preds)),
+      ws2(preds)
+   {
+   }
+};
+
+TEST_F(GOAPWorldStateTest, Equality)
+{
+   EXPECT_TRUE(ws1 == ws2);
+   EXPECT_EQ(ws1.hash(), ws2.hash());
+   // Predicates set in a different order give the same hash.
+   ws1.set(1, 4);
+   ws1.set(2, 5);
+   ws2.set(2, 5);
+   EXPECT_FALSE(ws1 == ws2);
+   EXPECT_NE(ws1.hash(), ws2.hash());
+   ws2.set(1, 4);
+   EXPECT_TRUE(ws1 == ws2);
+   EXPECT_EQ(ws1.hash(), ws2.hash());
+   // The hash depends on each predicate's parameter.
+   ws1.set(1, 3);
+   EXPECT_FALSE(ws1 == ws2);
+   EXPECT_NE(ws1.hash(), ws2.hash());
+   ws1.set(1, 4);
+   EXPECT_EQ(ws1.hash(), ws2.hash());
+   // Unsetting a predicate removes it from the hash.
+   WorldState::paramlist params(1, 4);
+   ws1.unset(1, params);
+   ws2.unset(1, params);
+   EXPECT_TRUE(ws1 == ws2);
+   EXPECT_EQ(ws1.hash(), ws2.hash());
+}
@@ -0,0 +1,90 @@
+/// @file AesopHashIndexTest.h
+/// gtest cases for HashIndex class.
+
+#include "gtest/gtest.h"
+#include "AesopHashIndex.h"
+
+using namespace Aesop;
+
+/// Test fixture for the HashIndex class.
+/// @ingroup AesopTest
+class HashIndexTest : public ::testing::Test {
+protected:
+   HashIndex index;
+
+   HashIndexTest()
+   {
+   }
+};
+
+TEST_F(HashIndexTest, Empty)
+{
+   unsigned int slot = HashIndex::None;
+   EXPECT_EQ(index.size(), 0u);
+   EXPECT_EQ(index.find(5, slot), HashIndex::None);
+   EXPECT_FALSE(index.erase(5, 0));
+}
+
+TEST_F(HashIndexTest, Find)
+{
+   index.insert(5, 0);
+   index.insert(7, 1);
+   // A second entry with the same hash.
+   index.insert(5, 2);
+   EXPECT_EQ(index.size(), 3u);
+
+   // Both entries with hash 5 should be found, in any order.
+   unsigned int slot = HashIndex::None;
+   unsigned int a = index.find(5, slot);
+   unsigned int b = index.find(5, slot);
+   EXPECT_EQ(a + b, 2u);
+   EXPECT_NE(a, b);
+   EXPECT_EQ(index.find(5, slot), HashIndex::None);
+
+   slot = HashIndex::None;
+   EXPECT_EQ(index.find(7, slot), 1u);
+   slot = HashIndex::None;
+   EXPECT_EQ(index.find(9, slot), HashIndex::None);
+}
+
+TEST_F(HashIndexTest, Erase)
+{
+   // Enough entries to force the table to grow and probe runs to form.
+   for(unsigned int i = 0; i < 100; i++)
+      index.insert(i % 10, i);
+   EXPECT_EQ(index.size(), 100u);
+
+   // Remove every entry with an even index.
+   for(unsigned int i = 0; i < 100; i += 2)
+      EXPECT_TRUE(index.erase(i % 10, i));
+   EXPECT_EQ(index.size(), 50u);
+
+   // All odd indices must still be reachable.
+   for(unsigned int i = 1; i < 100; i += 2)
+   {
+      unsigned int slot = HashIndex::None;
+      unsigned int found;
+      while((found = index.find(i % 10, slot)) != HashIndex::None && found != i) {}
+      EXPECT_EQ(found, i);
+   }
+
+   index.clear();
+   EXPECT_EQ(index.size(), 0u);
+}
+
+TEST_F(HashIndexTest, Clear)
+{
+   for(unsigned int i = 0; i < 100; i++)
+      index.insert(i, i);
+   index.clear();
+   // Nothing from before the clear can be found or erased.
+   unsigned int slot = HashIndex::None;
+   EXPECT_EQ(index.find(5, slot), HashIndex::None);
+   EXPECT_FALSE(index.erase(5, 5));
+   // The table works as normal afterwards.
+   index.insert(5, 200);
+   slot = HashIndex::None;
+   EXPECT_EQ(index.find(5, slot), 200u);
+   EXPECT_EQ(index.find(5, slot), HashIndex::None);
+   EXPECT_EQ(index.size(), 1u);
+}
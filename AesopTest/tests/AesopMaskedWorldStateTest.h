@@ -0,0 +1,107 @@
+/// @file AesopMaskedWorldStateTest.h
+/// gtest cases for MaskedWorldState class.
+
+#include "gtest/gtest.h"
+#include "AesopSimplePredicates.h"
+#include "AesopMaskedWorldState.h"
+
+using namespace Aesop;
+
+/// Test fixture for the MaskedWorldState class. Uses enough predicates to
+/// span several words of storage.
+/// @ingroup AesopTest
+class MaskedWorldStateTest : public ::testing::Test {
+protected:
+   enum {
+      NUMPREDS = 150
+   };
+
+   SimplePredicates preds;
+   MaskedWorldState ws1;
+   MaskedWorldState ws2;
+
+   MaskedWorldStateTest()
+      : ws1((preds.define(NUMPREDS), preds)),
+      ws2(preds)
+   {
+   }
+};
+
+TEST_F(MaskedWorldStateTest, Predicates)
+{
+   // New states don't care about anything.
+   EXPECT_FALSE(ws1.isSet(0));
+   EXPECT_FALSE(ws1.isUnset(0));
+   // Set and unset predicates either side of a word boundary.
+   ws1.set(63);
+   ws1.unset(64);
+   EXPECT_TRUE(ws1.isSet(63));
+   EXPECT_FALSE(ws1.isUnset(63));
+   EXPECT_TRUE(ws1.isUnset(64));
+   EXPECT_FALSE(ws1.isSet(64));
+   EXPECT_FALSE(ws1.isUnset(62));
+   EXPECT_FALSE(ws1.isUnset(65));
+   // Clearing a predicate forgets its value.
+   ws1.clear(63);
+   EXPECT_FALSE(ws1.isSet(63));
+   EXPECT_FALSE(ws1.isUnset(63));
+   EXPECT_TRUE(ws1.isUnset(64));
+   // Caring about everything makes unknown predicates unset.
+   ws2.set(100);
+   ws2.careAll();
+   EXPECT_TRUE(ws2.isSet(100));
+   EXPECT_TRUE(ws2.isUnset(0));
+   EXPECT_TRUE(ws2.isUnset(NUMPREDS - 1));
+   // Predicates out of range are never set or unset.
+   EXPECT_FALSE(ws2.isUnset(NUMPREDS));
+}
+
+TEST_F(MaskedWorldStateTest, Equality)
+{
+   EXPECT_TRUE(ws1 == ws2);
+   // A known value differs from an unknown one.
+   ws1.unset(10);
+   EXPECT_TRUE(ws1 != ws2);
+   ws1.clear(10);
+   EXPECT_TRUE(ws1 == ws2);
+   EXPECT_EQ(ws1.hash(), ws2.hash());
+   // Differences are only counted where both states care.
+   ws1.set(10);
+   ws1.set(120);
+   ws2.unset(120);
+   EXPECT_EQ(ws1.compare(ws2), 1u);
+   EXPECT_EQ(ws2.compare(ws1), 1u);
+}
+
+TEST_F(MaskedWorldStateTest, Satisfaction)
+{
+   // Anything satisfies a state that cares about nothing.
+   ws1.set(5);
+   EXPECT_TRUE(ws1.satisfies(ws2));
+   EXPECT_FALSE(ws2.satisfies(ws1));
+   // Values that are wanted must be known, and equal.
+   ws2.set(5);
+   ws2.unset(140);
+   EXPECT_FALSE(ws1.satisfies(ws2));
+   ws1.set(140);
+   EXPECT_FALSE(ws1.satisfies(ws2));
+   ws1.unset(140);
+   EXPECT_TRUE(ws1.satisfies(ws2));
+   EXPECT_TRUE(ReachedGoal(ws1, ws2));
+}
+
+TEST_F(MaskedWorldStateTest, Subsumption)
+{
+   ws1.set(0);
+   ws1.unset(70);
+   ws2.set(0);
+   // A state that asks for less is more general.
+   EXPECT_TRUE(ws2.subsumes(ws1));
+   EXPECT_FALSE(ws1.subsumes(ws2));
+   // States subsume themselves.
+   EXPECT_TRUE(ws1.subsumes(ws1));
+   // States that disagree don't subsume each other.
+   ws2.unset(0);
+   EXPECT_FALSE(ws2.subsumes(ws1));
+   EXPECT_FALSE(ws1.subsumes(ws2));
+}
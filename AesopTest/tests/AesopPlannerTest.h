@@ -1,8 +1,1365 @@
 /// @file AesopPlannerTest.h
-/// gtest cases for Planner class.
+/// gtest cases for planning algorithms.
 
 #include "gtest/gtest.h"
-#include "AesopPlanner.h"
+#include "AesopSimplePredicates.h"
+#include "AesopSimpleActionSet.h"
+#include "AesopSimpleWorldState.h"
+#include "AesopMaskedWorldState.h"
+#include "AesopStaticWorldState.h"
+#include "AesopReverseAstar.h"
+#include "AesopForwardAstar.h"
+#include "AesopBidirectionalAstar.h"
+#include "AesopIDAstar.h"
+#include "AesopSMAstar.h"
+#include "AesopARAstar.h"
+#include "AesopPatternDatabase.h"
+#include "AesopPolicyTable.h"
 
 using namespace Aesop;
 
+/// Test fixture for the planning algorithms, using a small combat domain.
+/// @ingroup AesopTest
+class PlannerTest : public ::testing::Test {
+protected:
+   enum {
+      gunLoaded,
+      gunEquipped,
+      haveGun,
+      haveTarget,
+      targetDead,
+      NUMPREDS
+   };
+
+   SimplePredicates preds;
+   SimpleActionSet actions;
+   SimpleWorldState init;
+   SimpleWorldState goal;
+   NullContext ctx;
+
+   PlannerTest()
+      : actions(preds),
+      init((preds.define(NUMPREDS), preds)),
+      goal(preds)
+   {
+      actions.create("attack");
+      actions.condition(haveTarget, true);
+      actions.condition(gunLoaded, true);
+      actions.condition(targetDead, false);
+      actions.effect(targetDead, true);
+      actions.effect(gunLoaded, false);
+      actions.add();
+
+      actions.create("loadGun");
+      actions.condition(gunEquipped, true);
+      actions.condition(gunLoaded, false);
+      actions.effect(gunLoaded, true);
+      actions.add();
+
+      actions.create("drawGun");
+      actions.condition(haveGun, true);
+      actions.condition(gunEquipped, false);
+      actions.effect(gunEquipped, true);
+      actions.add();
+
+      actions.create("findGun");
+      actions.condition(haveGun, false);
+      actions.effect(haveGun, true);
+      actions.add();
+
+      init.set(haveTarget);
+      goal.set(haveTarget);
+      goal.set(haveGun);
+      goal.set(gunEquipped);
+      goal.set(targetDead);
+   }
+
+   /// Execute a plan from the initial state and check that it reaches the
+   /// goal state.
+   bool reachesGoal(const Plan &plan)
+   {
+      SimpleWorldState ws(init);
+      Plan::const_iterator it;
+      for(it = plan.begin(); it != plan.end(); it++)
+      {
+         if(!actions.preMatch(it->action, it->parameters, ws))
+            return false;
+         actions.applyForward(it->action, it->parameters, ws);
+      }
+      return ws == goal;
+   }
+
+   /// Add an action that does the work of three others in one step.
+   void addShortcut(float cost)
+   {
+      actions.create("buyLoadedGun");
+      actions.condition(haveGun, false);
+      actions.condition(gunEquipped, false);
+      actions.condition(gunLoaded, false);
+      actions.effect(haveGun, true);
+      actions.effect(gunEquipped, true);
+      actions.effect(gunLoaded, true);
+      actions.cost(cost);
+      actions.add();
+   }
+
+   /// Do two plans take the same actions?
+   bool samePlan(const Plan &a, const Plan &b)
+   {
+      Plan::const_iterator i, j;
+      for(i = a.begin(), j = b.begin(); i != a.end() && j != b.end(); i++, j++)
+      {
+         if(i->action != j->action)
+            return false;
+      }
+      return i == a.end() && j == b.end();
+   }
+
+   /// Count the number of steps in a plan.
+   unsigned int length(const Plan &plan)
+   {
+      unsigned int l = 0;
+      Plan::const_iterator it;
+      for(it = plan.begin(); it != plan.end(); it++)
+         l++;
+      return l;
+   }
+};
+
+TEST_F(PlannerTest, ReverseAstar)
+{
+   Plan plan;
+   ASSERT_TRUE(ReverseAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, ForwardAstar)
+{
+   Plan plan;
+   ASSERT_TRUE(ForwardAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, ForwardAstarNoPlan)
+{
+   // Nothing can make the target come back to life.
+   init.set(targetDead);
+   goal.unset(targetDead);
+   Plan plan;
+   EXPECT_FALSE(ForwardAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 0u);
+}
+
+TEST_F(PlannerTest, BidirectionalAstar)
+{
+   Plan plan;
+   ASSERT_TRUE(BidirectionalAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+/// Context that counts the planning sessions begun and ended.
+class PlanningCounter : public NullContext {
+public:
+   unsigned int begun, ended;
+   PlanningCounter() : begun(0), ended(0) {}
+   virtual void beginPlanning() { begun++; }
+   virtual void endPlanning() { ended++; }
+};
+
+TEST_F(PlannerTest, BidirectionalAstarBeginsOnce)
+{
+   // Both searches are run, but make up a single planning session.
+   PlanningCounter counter;
+   Plan plan;
+   ASSERT_TRUE(BidirectionalAstarSolve(init, goal, actions, NoObjects, plan, counter));
+   EXPECT_EQ(counter.begun, 1u);
+   EXPECT_EQ(counter.ended, 1u);
+}
+
+/// Context that checks that iterations are never nested, and that success
+/// and failure are only reported inside one.
+class IterationChecker : public NullContext {
+public:
+   bool inside, ok;
+   unsigned int successes, failures;
+   IterationChecker() : inside(false), ok(true), successes(0), failures(0) {}
+   virtual void success() { ok = ok && inside; successes++; }
+   virtual void failure() { ok = ok && inside; failures++; }
+   virtual void beginIteration() { ok = ok && !inside; inside = true; }
+   virtual void endIteration() { ok = ok && inside; inside = false; }
+};
+
+TEST_F(PlannerTest, BidirectionalAstarIterations)
+{
+   IterationChecker found;
+   Plan plan;
+   ASSERT_TRUE(BidirectionalAstarSolve(init, goal, actions, NoObjects, plan, found));
+   EXPECT_TRUE(found.ok);
+   EXPECT_FALSE(found.inside);
+   EXPECT_EQ(found.successes, 1u);
+   EXPECT_EQ(found.failures, 0u);
+
+   IterationChecker lost;
+   init.set(targetDead);
+   goal.unset(targetDead);
+   plan.clear();
+   EXPECT_FALSE(BidirectionalAstarSolve(init, goal, actions, NoObjects, plan, lost));
+   EXPECT_TRUE(lost.ok);
+   EXPECT_FALSE(lost.inside);
+   EXPECT_EQ(lost.successes, 0u);
+   EXPECT_EQ(lost.failures, 1u);
+}
+
+TEST_F(PlannerTest, BidirectionalAstarChain)
+{
+   // A chain of actions that each pass a token to the next predicate.
+   SimplePredicates cpreds;
+   cpreds.define(10);
+   SimpleActionSet chain(cpreds);
+   for(unsigned int i = 0; i < 9; i++)
+   {
+      chain.create("pass");
+      chain.condition(i, true);
+      chain.condition(i + 1, false);
+      chain.effect(i, false);
+      chain.effect(i + 1, true);
+      chain.add();
+   }
+   SimpleWorldState first(cpreds), last(cpreds);
+   first.set(0);
+   last.set(9);
+
+   BidirectionalProblem<SimpleWorldState> prob;
+   ASSERT_TRUE(BidirectionalAstarInit(first, last, prob, ctx));
+   while(BidirectionalAstarIteration(prob, chain, NoObjects, ctx)) {}
+   ASSERT_TRUE(prob.success);
+   // The searches should have met somewhere in the middle.
+   EXPECT_NE(prob.forwardMeet, HashIndex::None);
+   EXPECT_NE(prob.reverseMeet, HashIndex::None);
+
+   Plan plan;
+   BidirectionalAstarFinalise(prob, plan, ctx);
+   SimpleWorldState ws(first);
+   unsigned int steps = 0;
+   Plan::const_iterator it;
+   for(it = plan.begin(); it != plan.end(); it++, steps++)
+   {
+      ASSERT_TRUE(chain.preMatch(it->action, it->parameters, ws));
+      chain.applyForward(it->action, it->parameters, ws);
+   }
+   EXPECT_EQ(steps, 9u);
+   EXPECT_TRUE(ws == last);
+}
+
+TEST_F(PlannerTest, BidirectionalAstarMaskedChain)
+{
+   // As above, but the goal only asks for the token to reach the end, so
+   // the reverse search never holds a full state.
+   SimplePredicates cpreds;
+   cpreds.define(10);
+   SimpleActionSet chain(cpreds);
+   for(unsigned int i = 0; i < 9; i++)
+   {
+      chain.create("pass");
+      chain.condition(i, true);
+      chain.condition(i + 1, false);
+      chain.effect(i, false);
+      chain.effect(i + 1, true);
+      chain.add();
+   }
+   MaskedWorldState first(cpreds), last(cpreds);
+   first.set(0);
+   first.careAll();
+   last.set(9);
+
+   BidirectionalProblem<MaskedWorldState> prob;
+   ASSERT_TRUE(BidirectionalAstarInit(first, last, prob, ctx));
+   while(BidirectionalAstarIteration(prob, chain, NoObjects, ctx)) {}
+   ASSERT_TRUE(prob.success);
+   // The searches should have met somewhere in the middle.
+   EXPECT_NE(prob.forwardMeet, HashIndex::None);
+   EXPECT_NE(prob.reverseMeet, HashIndex::None);
+
+   Plan plan;
+   BidirectionalAstarFinalise(prob, plan, ctx);
+   MaskedWorldState ws(first);
+   unsigned int steps = 0;
+   Plan::const_iterator it;
+   for(it = plan.begin(); it != plan.end(); it++, steps++)
+   {
+      ASSERT_TRUE(chain.preMatch(it->action, it->parameters, ws));
+      chain.applyForward(it->action, it->parameters, ws);
+   }
+   EXPECT_EQ(steps, 9u);
+   EXPECT_TRUE(ws.satisfies(last));
+}
+
+TEST_F(PlannerTest, IDAstar)
+{
+   Plan plan;
+   ASSERT_TRUE(IDAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, IDAstarNoPlan)
+{
+   init.set(targetDead);
+   goal.unset(targetDead);
+   Plan plan;
+   EXPECT_FALSE(IDAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 0u);
+}
+
+/// Context that counts forgotten states.
+class ForgetCounter : public NullContext {
+public:
+   unsigned int count;
+   ForgetCounter() : count(0) {}
+   virtual void forgotten(unsigned int ID) { count++; }
+};
+
+TEST_F(PlannerTest, SMAstar)
+{
+   Plan plan;
+   ASSERT_TRUE(SMAstarSolve(init, goal, actions, NoObjects, 100, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, SMAstarMemoryBound)
+{
+   // Just enough memory to hold the solution path.
+   const unsigned int maxNodes = 5;
+   ForgetCounter counter;
+   SMAProblem<SimpleWorldState> prob;
+   ASSERT_TRUE(SMAstarInit(init, goal, maxNodes, prob, counter));
+   while(SMAstarIteration(prob, actions, NoObjects, counter))
+      ASSERT_LE(prob.size(), maxNodes);
+   ASSERT_TRUE(prob.success);
+   EXPECT_GT(counter.count, 0u);
+
+   Plan plan;
+   SMAstarFinalise(prob, plan, counter);
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, SMAstarTooLittleMemory)
+{
+   // The solution path is longer than we can remember.
+   Plan plan;
+   EXPECT_FALSE(SMAstarSolve(init, goal, actions, NoObjects, 4, plan, ctx));
+}
+
+TEST_F(PlannerTest, SMAstarNoPlan)
+{
+   // However much memory there is, the search must give up.
+   init.set(targetDead);
+   goal.unset(targetDead);
+   for(unsigned int maxNodes = 1; maxNodes <= 12; maxNodes++)
+   {
+      Plan plan;
+      EXPECT_FALSE(SMAstarSolve(init, goal, actions, NoObjects, maxNodes, plan, ctx));
+      EXPECT_EQ(length(plan), 0u);
+   }
+}
+
+/// Follow a plan from one state to another.
+/// @return Total cost of the plan, or a negative value if it doesn't
+///         reach the goal.
+float planCost(const SimpleActionSet &actions, const Plan &plan, SimpleWorldState ws, const SimpleWorldState &goal)
+{
+   float cost = 0.0f;
+   Plan::const_iterator it;
+   for(it = plan.begin(); it != plan.end(); it++)
+   {
+      if(!actions.preMatch(it->action, it->parameters, ws))
+         return -1.0f;
+      cost += actions.cost(it->action, it->parameters, ws);
+      actions.applyForward(it->action, it->parameters, ws);
+   }
+   return ws == goal ? cost : -1.0f;
+}
+
+TEST_F(PlannerTest, SMAstarOptimal)
+{
+   // Move a token around a graph of eight places. The cheapest route takes
+   // four steps, and there are dearer ones of three and four steps. Every
+   // move costs at least 2, so the default heuristic is admissible.
+   SimplePredicates gpreds;
+   gpreds.define(8);
+   SimpleActionSet graph(gpreds);
+   const unsigned int edges[][3] = {
+      {0, 1, 6}, {0, 2, 2}, {1, 3, 2}, {2, 3, 10}, {2, 4, 4}, {3, 5, 4},
+      {4, 5, 8}, {4, 6, 2}, {5, 7, 2}, {6, 7, 12}, {3, 7, 14}, {1, 6, 18},
+   };
+   for(unsigned int e = 0; e < sizeof(edges) / sizeof(edges[0]); e++)
+   {
+      for(unsigned int d = 0; d < 2; d++)
+      {
+         unsigned int from = edges[e][d], to = edges[e][1 - d];
+         graph.create("move");
+         graph.condition(from, true);
+         graph.condition(to, false);
+         graph.effect(from, false);
+         graph.effect(to, true);
+         graph.cost((float)edges[e][2]);
+         graph.add();
+      }
+   }
+   SimpleWorldState start(gpreds), end(gpreds);
+   start.set(0);
+   end.set(7);
+
+   Plan plan;
+   ASSERT_TRUE(UniformCostSolve(start, end, graph, NoObjects, plan, ctx));
+   const float best = planCost(graph, plan, start, end);
+   EXPECT_EQ(best, 14.0f);
+
+   // With room for the cheapest route, nothing dearer is accepted. With
+   // less, the search may fail or settle for a shorter route.
+   for(unsigned int maxNodes = 1; maxNodes <= 12; maxNodes++)
+   {
+      plan.clear();
+      bool found = SMAstarSolve(start, end, graph, NoObjects, maxNodes, plan, ctx);
+      if(maxNodes > 4)
+      {
+         ASSERT_TRUE(found);
+         EXPECT_EQ(planCost(graph, plan, start, end), best);
+      }
+      else if(found)
+      {
+         EXPECT_GE(planCost(graph, plan, start, end), best);
+      }
+   }
+}
+
+TEST_F(PlannerTest, ARAstar)
+{
+   Plan plan;
+   ASSERT_TRUE(ARAstarSolve(init, goal, actions, NoObjects, 5.0f, Budget(), plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, ARAstarAnytime)
+{
+   ARAProblem<SimpleWorldState> prob;
+   ASSERT_TRUE(ARAstarInit(init, goal, 5.0f, 1.0f, prob, ctx));
+   // A plan is published before the search has finished.
+   while(!prob.success)
+      ASSERT_EQ(ARAstarStep(prob, actions, NoObjects, Budget(1), ctx), SearchInProgress);
+   Plan plan;
+   ARAstarPublish(prob, plan);
+   EXPECT_TRUE(reachesGoal(plan));
+   EXPECT_GT(prob.weight, 1.0f);
+
+   // Carrying on lowers the weight until the plan is optimal.
+   EXPECT_EQ(ARAstarStep(prob, actions, NoObjects, Budget(), ctx), SearchSolved);
+   EXPECT_EQ(prob.weight, 1.0f);
+   ARAstarFinalise(prob, plan, ctx);
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, ARAstarNoPlan)
+{
+   init.set(targetDead);
+   goal.unset(targetDead);
+   Plan plan;
+   EXPECT_FALSE(ARAstarSolve(init, goal, actions, NoObjects, 3.0f, Budget(), plan, ctx));
+   EXPECT_EQ(length(plan), 0u);
+}
+
+TEST_F(PlannerTest, UniformCost)
+{
+   Plan plan;
+   ASSERT_TRUE(UniformCostSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, ExpensiveShortcut)
+{
+   // Two steps, but dearer than the four-step plan.
+   addShortcut(5.0f);
+   Plan plan;
+   ASSERT_TRUE(UniformCostSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   plan.clear();
+   ASSERT_TRUE(ReverseAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   plan.clear();
+   ASSERT_TRUE(ForwardAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   plan.clear();
+   ASSERT_TRUE(IDAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   plan.clear();
+   ASSERT_TRUE(SMAstarSolve(init, goal, actions, NoObjects, 100, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   plan.clear();
+   ASSERT_TRUE(ARAstarSolve(init, goal, actions, NoObjects, 3.0f, Budget(), plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, CheapShortcut)
+{
+   // Counting differing predicates overestimates the cost here, so only a
+   // search without a heuristic is sure to find the cheaper plan.
+   addShortcut(1.5f);
+   Plan plan;
+   ASSERT_TRUE(UniformCostSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 2u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, RelaxedHeuristics)
+{
+   // Getting the gun, drawing, loading and firing it cost 1, 2, 3 and 4.
+   MaxHeuristic hmax(actions);
+   AddHeuristic hadd(actions);
+   EXPECT_EQ(hmax(init, goal), 4.0f);
+   EXPECT_EQ(hadd(init, goal), 7.0f);
+   EXPECT_EQ(hmax(goal, goal), 0.0f);
+   // Nothing can make the target come back to life.
+   EXPECT_EQ(hmax(goal, init), RelaxedHeuristic::unreachable);
+}
+
+TEST_F(PlannerTest, HeuristicPolicies)
+{
+   Plan plan;
+   ASSERT_TRUE(ReverseAstarSolve(init, goal, actions, NoObjects, MaxHeuristic(actions), plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+   plan.clear();
+   ASSERT_TRUE(ForwardAstarSolve(init, goal, actions, NoObjects, AddHeuristic(actions), plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+   plan.clear();
+   ASSERT_TRUE(IDAstarSolve(init, goal, actions, NoObjects, MaxHeuristic(actions), plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   plan.clear();
+   ASSERT_TRUE(SMAstarSolve(init, goal, actions, NoObjects, NullHeuristic(), 100, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+}
+
+TEST_F(PlannerTest, FFHeuristic)
+{
+   FFHeuristic hff(actions);
+   EXPECT_EQ(hff(init, goal), 4.0f);
+   EXPECT_EQ(hff(goal, init), RelaxedHeuristic::unreachable);
+
+   // Only finding the gun can start the plan.
+   std::vector<bool> helpful;
+   ASSERT_TRUE(HelpfulActions(hff, init, goal, false, helpful));
+   ASSERT_EQ(helpful.size(), actions.size());
+   EXPECT_TRUE(helpful[3]);
+   EXPECT_FALSE(helpful[0] || helpful[1] || helpful[2]);
+   // Loading the gun doesn't reach anything the goal asks for directly.
+   ASSERT_TRUE(HelpfulActions(hff, init, goal, true, helpful));
+   EXPECT_TRUE(helpful[0] && helpful[2] && helpful[3]);
+   EXPECT_FALSE(helpful[1]);
+
+   // Other heuristics have no preference.
+   GoalCountHeuristic hgc;
+   EXPECT_FALSE(HelpfulActions(hgc, init, goal, false, helpful));
+
+   Plan plan;
+   ASSERT_TRUE(ForwardAstarSolve(init, goal, actions, NoObjects, hff, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+   plan.clear();
+   ASSERT_TRUE(ReverseAstarSolve(init, goal, actions, NoObjects, hff, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, FFHeuristicFreeAction)
+{
+   // A literal reached by a free action is not true to begin with.
+   SimpleActionSet free(preds);
+   free.create("findGun");
+   free.effect(haveGun, true);
+   free.cost(0.0f);
+   free.add();
+   free.create("shoot");
+   free.condition(haveGun, true);
+   free.effect(targetDead, true);
+   free.add();
+   SimpleWorldState start(preds), end(preds);
+   end.set(targetDead);
+
+   FFHeuristic hff(free);
+   EXPECT_EQ(hff(start, end), 1.0f);
+   std::vector<bool> helpful;
+   ASSERT_TRUE(HelpfulActions(hff, start, end, false, helpful));
+   EXPECT_TRUE(helpful[0]);
+   EXPECT_FALSE(helpful[1]);
+}
+
+/// Has the same estimates as FFHeuristic, but no helpful actions, since
+/// HelpfulActions is only overloaded for FFHeuristic itself.
+/// @ingroup AesopTest
+struct UnhelpfulFF : public FFHeuristic {
+   UnhelpfulFF(const SimpleActionSet &actions) : FFHeuristic(actions) {}
+};
+
+/// Count the nodes a progressive A* search closes.
+/// @ingroup AesopTest
+template < class H >
+unsigned int countExpansions(const MaskedWorldState &start, const MaskedWorldState &end, const SimpleActionSet &actions, const H &heuristic, Plan &plan)
+{
+   NullContext ctx;
+   Problem<MaskedWorldState, H> prob(heuristic);
+   if(!ForwardAstarInit(start, end, prob, ctx))
+      return 0;
+   while(ForwardAstarIteration(prob, actions, NoObjects, ctx)) {}
+   ForwardAstarFinalise(prob, plan, ctx);
+   return prob.success ? prob.closed.size() : 0;
+}
+
+TEST_F(PlannerTest, HelpfulActionsExpandLess)
+{
+   // Each delivery uses up the single load, which the relaxed plan only
+   // counts once, so the estimate is low and cheap errands that the goal
+   // doesn't care about look as promising as the deliveries.
+   enum { loaded, deliveries = 3, errands = 4 };
+   SimplePredicates p;
+   p.define(1 + deliveries + errands);
+   SimpleActionSet work(p);
+   work.create("load");
+   work.condition(loaded, false);
+   work.effect(loaded, true);
+   work.add();
+   MaskedWorldState start(p), end(p);
+   start.careAll();
+   for(unsigned int i = 0; i < deliveries; i++)
+   {
+      work.create("deliver");
+      work.condition(loaded, true);
+      work.condition(1 + i, false);
+      work.effect(loaded, false);
+      work.effect(1 + i, true);
+      work.add();
+      end.set(1 + i);
+   }
+   for(unsigned int i = 0; i < errands; i++)
+   {
+      work.create("errand");
+      work.condition(1 + deliveries + i, false);
+      work.effect(1 + deliveries + i, true);
+      work.cost(0.5f);
+      work.add();
+   }
+
+   Plan helped, unhelped;
+   unsigned int withHelp = countExpansions(start, end, work, FFHeuristic(work), helped);
+   unsigned int withoutHelp = countExpansions(start, end, work, UnhelpfulFF(work), unhelped);
+   ASSERT_NE(withHelp, 0u);
+   ASSERT_NE(withoutHelp, 0u);
+   EXPECT_LT(withHelp, withoutHelp);
+   EXPECT_EQ(length(helped), 2u * deliveries);
+   EXPECT_EQ(length(unhelped), 2u * deliveries);
+}
+
+TEST_F(PlannerTest, PatternDatabase)
+{
+   PatternDatabase::pattern target, gun;
+   target.push_back(targetDead);
+   target.push_back(haveTarget);
+   gun.push_back(haveGun);
+   gun.push_back(gunEquipped);
+   gun.push_back(gunLoaded);
+
+   PatternDatabase pdb(actions);
+   EXPECT_FALSE(pdb.addPattern(PatternDatabase::pattern()));
+   ASSERT_TRUE(pdb.addPattern(target));
+   ASSERT_TRUE(pdb.addPattern(gun));
+   EXPECT_FALSE(pdb.addPattern(target));
+   pdb.build(init, true);
+   EXPECT_EQ(pdb.size(), 4u + 8u);
+   // Attacking is charged to the first pattern, so the second only counts
+   // finding and drawing the gun.
+   EXPECT_EQ(pdb(init, goal), 3.0f);
+   EXPECT_EQ(pdb(init, init), 0.0f);
+
+   Plan plan;
+   ASSERT_TRUE(ReverseAstarSolve(init, goal, actions, NoObjects, PatternHeuristic(pdb), plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+
+   // The same patterns work towards the goal for a progressive search.
+   pdb.build(goal, false);
+   EXPECT_EQ(pdb(init, goal), 3.0f);
+   EXPECT_EQ(pdb(goal, goal), 0.0f);
+   EXPECT_EQ(pdb(goal, init), 0.0f);
+   plan.clear();
+   ASSERT_TRUE(ForwardAstarSolve(init, goal, actions, NoObjects, PatternHeuristic(pdb), plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, PatternDatabasePartialStates)
+{
+   PatternDatabase::pattern target, gun;
+   target.push_back(targetDead);
+   target.push_back(haveTarget);
+   gun.push_back(haveGun);
+   gun.push_back(gunEquipped);
+   gun.push_back(gunLoaded);
+   PatternDatabase pdb(actions);
+   ASSERT_TRUE(pdb.addPattern(target));
+   ASSERT_TRUE(pdb.addPattern(gun));
+
+   // A goal that only asks for the target to be dead, and doesn't care
+   // whether it is still around.
+   MaskedWorldState minit(preds), mgoal(preds);
+   for(unsigned int p = 0; p < NUMPREDS; p++)
+   {
+      if(init.isSet(p)) minit.set(p);
+      else minit.unset(p);
+   }
+   mgoal.set(targetDead);
+
+   // Only attacking is needed in the target pattern, whichever way the
+   // unknown predicates turn out.
+   pdb.build(minit, true);
+   EXPECT_EQ(pdb(minit, mgoal), 1.0f);
+   Plan plan;
+   ASSERT_TRUE(ReverseAstarSolve(minit, mgoal, actions, NoObjects, PatternHeuristic(pdb), plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+
+   pdb.build(mgoal, false);
+   EXPECT_EQ(pdb(minit, mgoal), 1.0f);
+   plan.clear();
+   ASSERT_TRUE(ForwardAstarSolve(minit, mgoal, actions, NoObjects, PatternHeuristic(pdb), plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+}
+
+TEST_F(PlannerTest, PolicyTable)
+{
+   EXPECT_EQ(PolicyTable::estimateSize(NUMPREDS), 32 * (sizeof(float) + sizeof(unsigned short)));
+   // Too little memory to tabulate the domain.
+   PolicyTable small(actions, 64);
+   EXPECT_FALSE(small.build(goal));
+   EXPECT_FALSE(small.built());
+
+   PolicyTable table(actions);
+   ASSERT_TRUE(table.build(goal));
+   EXPECT_EQ(table.cost(init), 4.0f);
+   EXPECT_EQ(table.cost(goal), 0.0f);
+   Plan plan;
+   ASSERT_TRUE(table.solve(init, plan));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+
+   // Nothing brings the target back once it's gone.
+   SimpleWorldState lost(preds);
+   EXPECT_EQ(table.cost(lost), PolicyTable::unreachable);
+   plan.clear();
+   EXPECT_FALSE(table.solve(lost, plan));
+}
+
+TEST_F(PlannerTest, PolicyTableWiderActions)
+{
+   // The actions know more predicates than the states being tabulated.
+   SimplePredicates wide, narrow;
+   wide.define(40);
+   narrow.define(2);
+   SimpleActionSet acts(wide);
+   acts.create("first");
+   acts.condition(0, false);
+   acts.effect(0, true);
+   acts.add();
+   // Asks for something the table can't see, so is never used.
+   acts.create("cheat");
+   acts.condition(35, true);
+   acts.effect(0, true);
+   acts.effect(1, true);
+   acts.cost(0.5f);
+   acts.add();
+   // Changes predicates past the table's, both below and above 32.
+   acts.create("second");
+   acts.condition(0, true);
+   acts.effect(1, true);
+   acts.effect(3, true);
+   acts.effect(33, false);
+   acts.add();
+
+   SimpleWorldState start(narrow), end(narrow);
+   end.set(0);
+   end.set(1);
+   PolicyTable table(acts);
+   ASSERT_TRUE(table.build(end));
+   EXPECT_EQ(table.cost(start), 2.0f);
+   Plan plan;
+   ASSERT_TRUE(table.solve(start, plan));
+   ASSERT_EQ(length(plan), 2u);
+   EXPECT_EQ(acts.repr(plan.begin()->action), "first");
+   EXPECT_EQ(acts.repr((plan.begin() + 1)->action), "second");
+}
+
+TEST_F(PlannerTest, AdmissibleHeuristicFindsCheapShortcut)
+{
+   addShortcut(1.5f);
+   Plan plan;
+   ASSERT_TRUE(ReverseAstarSolve(init, goal, actions, NoObjects, MaxHeuristic(actions), plan, ctx));
+   EXPECT_EQ(length(plan), 2u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+/// Heuristic supplied by the user, which counts how often it is used.
+struct CountingHeuristic {
+   unsigned int calls;
+   CountingHeuristic() : calls(0) {}
+   float operator()(const SimpleWorldState &from, const SimpleWorldState &to)
+   {
+      calls++;
+      return (float)from.compare(to);
+   }
+};
+
+TEST_F(PlannerTest, UserHeuristic)
+{
+   Problem<SimpleWorldState, CountingHeuristic> prob;
+   ASSERT_TRUE(ReverseAstarInit(init, goal, prob, ctx));
+   while(ReverseAstarIteration(prob, actions, NoObjects, ctx)) {}
+   ASSERT_TRUE(prob.success);
+   EXPECT_GT(prob.heuristic.calls, 0u);
+}
+
+TEST_F(PlannerTest, StaticWorldState)
+{
+   typedef StaticWorldState<NUMPREDS> state;
+   state sinit(preds), sgoal(preds);
+   for(unsigned int p = 0; p < NUMPREDS; p++)
+   {
+      if(init.isSet(p)) sinit.set(p);
+      if(goal.isSet(p)) sgoal.set(p);
+   }
+   Plan plan;
+   ASSERT_TRUE(ReverseAstarSolve(sinit, sgoal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+   plan.clear();
+   ASSERT_TRUE(ForwardAstarSolve(sinit, sgoal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+/// Hides a WorldState's packed bits, so that actions must use its
+/// per-predicate methods.
+template < class WS >
+class Unpacked : public WS {
+public:
+   virtual unsigned int bitWords() const { return 0; }
+   Unpacked(const WS &ws) : WS(ws) {}
+};
+
+TEST_F(PlannerTest, PackedActions)
+{
+   // Try every action against every full and partial state of the domain.
+   unsigned int states = 1;
+   for(unsigned int p = 0; p < NUMPREDS; p++)
+      states *= 3;
+   for(unsigned int i = 0; i < states; i++)
+   {
+      SimpleWorldState full(preds);
+      MaskedWorldState partial(preds);
+      for(unsigned int p = 0, v = i; p < NUMPREDS; p++, v /= 3)
+      {
+         if(v % 3 == 1) { full.set(p); partial.set(p); }
+         else if(v % 3 == 2) partial.unset(p);
+      }
+      Unpacked<SimpleWorldState> ufull(full);
+      Unpacked<MaskedWorldState> upartial(partial);
+      ActionSet::const_iterator ac;
+      for(ac = actions.begin(); ac != actions.end(); ac++)
+      {
+         WorldState::paramlist params;
+         EXPECT_EQ(actions.preMatch(ac, params, full), actions.preMatch(ac, params, ufull));
+         EXPECT_EQ(actions.postMatch(ac, params, full), actions.postMatch(ac, params, ufull));
+         EXPECT_EQ(actions.preMatch(ac, params, partial), actions.preMatch(ac, params, upartial));
+         EXPECT_EQ(actions.postMatch(ac, params, partial), actions.postMatch(ac, params, upartial));
+
+         SimpleWorldState f1(full), f2(ufull);
+         actions.applyForward(ac, params, f1);
+         actions.applyForward(ac, params, f2);
+         EXPECT_TRUE(f1 == f2);
+         f1 = full; f2 = ufull;
+         actions.applyReverse(ac, params, f1);
+         actions.applyReverse(ac, params, f2);
+         EXPECT_TRUE(f1 == f2);
+
+         MaskedWorldState p1(partial), p2(upartial);
+         actions.applyForward(ac, params, p1);
+         actions.applyForward(ac, params, p2);
+         EXPECT_TRUE(p1 == p2);
+         p1 = partial; p2 = upartial;
+         actions.applyReverse(ac, params, p1);
+         actions.applyReverse(ac, params, p2);
+         EXPECT_TRUE(p1 == p2);
+      }
+   }
+}
+
+TEST_F(PlannerTest, ScratchState)
+{
+   // Apply every action in place and undo it again, for every full and
+   // partial state of the domain.
+   unsigned int states = 1;
+   for(unsigned int p = 0; p < NUMPREDS; p++)
+      states *= 3;
+   ScratchState<SimpleWorldState> fs;
+   ScratchState<MaskedWorldState> ps;
+   ScratchState<Unpacked<SimpleWorldState> > us;
+   for(unsigned int i = 0; i < states; i++)
+   {
+      SimpleWorldState full(preds);
+      MaskedWorldState partial(preds);
+      for(unsigned int p = 0, v = i; p < NUMPREDS; p++, v /= 3)
+      {
+         if(v % 3 == 1) { full.set(p); partial.set(p); }
+         else if(v % 3 == 2) partial.unset(p);
+      }
+      Unpacked<SimpleWorldState> ufull(full);
+      SimpleWorldState &f = fs.begin(full);
+      MaskedWorldState &m = ps.begin(partial);
+      Unpacked<SimpleWorldState> &u = us.begin(ufull);
+      ActionSet::const_iterator ac;
+      for(ac = actions.begin(); ac != actions.end(); ac++)
+      {
+         WorldState::paramlist params;
+         SimpleWorldState f1(full);
+         ApplyForward(actions, ac, params, f1);
+         ApplyForwardScratch(actions, ac, params, fs);
+         EXPECT_TRUE(f == f1);
+         ApplyForwardScratch(actions, ac, params, us);
+         EXPECT_TRUE(u == f1);
+         // The incremental hash must match one computed from scratch.
+         SimpleWorldState fresh(preds);
+         for(unsigned int p = 0; p < NUMPREDS; p++)
+            if(f.isSet(p)) fresh.set(p);
+         EXPECT_EQ(fresh.hash(), f.hash());
+         fs.undo();
+         us.undo();
+         EXPECT_TRUE(f == full);
+         EXPECT_TRUE(u == full);
+
+         MaskedWorldState p1(partial);
+         ApplyReverse(actions, ac, params, p1);
+         ApplyReverseScratch(actions, ac, params, ps);
+         EXPECT_TRUE(m == p1);
+         MaskedWorldState mfresh(preds);
+         for(unsigned int p = 0; p < NUMPREDS; p++)
+         {
+            if(m.isSet(p)) mfresh.set(p);
+            else if(m.isUnset(p)) mfresh.unset(p);
+         }
+         EXPECT_EQ(mfresh.hash(), m.hash());
+         ps.undo();
+         EXPECT_TRUE(m == partial);
+      }
+   }
+}
+
+TEST_F(PlannerTest, IDAstarCycles)
+{
+   // Dropping the gun undoes finding it, so paths can loop back on
+   // themselves.
+   actions.create("dropGun");
+   actions.condition(haveGun, true);
+   actions.condition(gunEquipped, false);
+   actions.effect(haveGun, false);
+   actions.add();
+   Plan plan;
+   ASSERT_TRUE(IDAstarSolve(init, goal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+
+   // States without packed bits are saved whole before each action.
+   Unpacked<SimpleWorldState> uinit(init), ugoal(goal);
+   plan.clear();
+   ASSERT_TRUE(IDAstarSolve(uinit, ugoal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, ScratchStateNested)
+{
+   // Actions applied on top of each other are undone in reverse order,
+   // whether their words were recorded or the whole state was saved.
+   ScratchState<SimpleWorldState> fs;
+   ScratchState<Unpacked<SimpleWorldState> > us;
+   Unpacked<SimpleWorldState> uinit(init);
+   SimpleWorldState &f = fs.begin(init);
+   Unpacked<SimpleWorldState> &u = us.begin(uinit);
+   std::vector<SimpleWorldState> path(1, init);
+   WorldState::paramlist params;
+   // findGun, drawGun, loadGun, attack.
+   for(ActionSet::const_iterator ac = 4; ac-- > 0; )
+   {
+      path.push_back(path.back());
+      ApplyForward(actions, ac, params, path.back());
+      ApplyForwardScratch(actions, ac, params, fs);
+      ApplyForwardScratch(actions, ac, params, us);
+   }
+   EXPECT_TRUE(f == goal);
+   EXPECT_TRUE(u == goal);
+   while(path.size() > 1)
+   {
+      path.pop_back();
+      fs.undo();
+      us.undo();
+      EXPECT_TRUE(f == path.back());
+      EXPECT_TRUE(u == path.back());
+      EXPECT_EQ(f.hash(), path.back().hash());
+   }
+}
+
+TEST_F(PlannerTest, ApplicableActions)
+{
+   // Enough actions that some are tested in groups and some alone.
+   addShortcut(1.0f);
+   actions.create("dropGun");
+   actions.condition(haveGun, true);
+   actions.effect(haveGun, false);
+   actions.effect(gunEquipped, false);
+   actions.add();
+   actions.create("wait");
+   actions.add();
+
+   std::vector<bitword> bits;
+   unsigned int states = 1;
+   for(unsigned int p = 0; p < NUMPREDS; p++)
+      states *= 3;
+   for(unsigned int i = 0; i < states; i++)
+   {
+      MaskedWorldState partial(preds);
+      for(unsigned int p = 0, v = i; p < NUMPREDS; p++, v /= 3)
+      {
+         if(v % 3 == 1) partial.set(p);
+         else if(v % 3 == 2) partial.unset(p);
+      }
+      for(int reverse = 0; reverse < 2; reverse++)
+      {
+         ASSERT_TRUE(actions.getApplicable(partial, reverse != 0, bits));
+         ActionSet::const_iterator ac;
+         for(ac = actions.begin(); ac != actions.end(); ac++)
+         {
+            bool match = reverse
+               ? actions.postMatch(ac, WorldState::paramlist(), partial)
+               : actions.preMatch(ac, WorldState::paramlist(), partial);
+            EXPECT_EQ((bits[wordIndex(ac)] & bitMask(ac)) != 0, match);
+         }
+      }
+   }
+
+   // States without packed bits get every action as a candidate.
+   Unpacked<SimpleWorldState> unpacked(init);
+   EXPECT_FALSE(actions.getApplicable(unpacked, false, bits));
+   EXPECT_EQ(nextBit(bits, 0), 0u);
+   EXPECT_EQ(nextBit(bits, 6), 6u);
+}
+
+TEST_F(PlannerTest, ApplicableActionsGrowing)
+{
+   // Actions added one at a time, reaching further into the state as they
+   // go, and more of them than fit in one word of the result.
+   const unsigned int count = 150;
+   SimplePredicates many;
+   many.define(count + 1);
+   SimpleActionSet chain(many);
+   SimpleWorldState ws(many);
+   std::vector<bitword> bits;
+   for(unsigned int a = 0; a < count; a++)
+   {
+      chain.create("pass");
+      chain.condition(a, true);
+      chain.effect(a, false);
+      chain.effect(a + 1, true);
+      chain.add();
+      // Only the newest action moves the token on from where it is now.
+      ws = SimpleWorldState(many);
+      ws.set(a);
+      ASSERT_TRUE(chain.getApplicable(ws, false, bits));
+      EXPECT_EQ(nextBit(bits, 0), a);
+      EXPECT_GE(nextBit(bits, a + 1), chain.end());
+      // Only the action before it could have put the token there.
+      ASSERT_TRUE(chain.getApplicable(ws, true, bits));
+      unsigned int first = nextBit(bits, 0);
+      if(a)
+      {
+         EXPECT_EQ(first, a - 1);
+         first = nextBit(bits, a);
+      }
+      EXPECT_GE(first, chain.end());
+   }
+   ws = SimpleWorldState(many);
+   ws.set(70);
+   ASSERT_TRUE(chain.getApplicable(ws, false, bits));
+   EXPECT_EQ(nextBit(bits, 0), 70u);
+   EXPECT_GE(nextBit(bits, 71), chain.end());
+   std::vector<ActionSet::const_iterator> list;
+   chain.getAchievers(130, true, list);
+   ASSERT_EQ(list.size(), 1u);
+   EXPECT_EQ(list[0], 129u);
+}
+
+TEST_F(PlannerTest, Achievers)
+{
+   addShortcut(1.0f);
+   std::vector<ActionSet::const_iterator> list;
+   actions.getAchievers(gunEquipped, true, list);
+   ASSERT_EQ(list.size(), 2u);
+   EXPECT_EQ(actions.repr(list[0]), "drawGun");
+   EXPECT_EQ(actions.repr(list[1]), "buyLoadedGun");
+   list.clear();
+   actions.getAchievers(haveTarget, true, list);
+   EXPECT_TRUE(list.empty());
+
+   // Regressing a state without packed bits only considers actions that
+   // achieve something it asks for.
+   MaskedWorldState ws(preds);
+   ws.set(targetDead);
+   Unpacked<MaskedWorldState> unpacked(ws);
+   std::vector<bitword> bits;
+   EXPECT_FALSE(actions.getApplicable(unpacked, true, bits));
+   unsigned int a = nextBit(bits, 0);
+   ASSERT_LT(a, actions.end());
+   EXPECT_EQ(actions.repr(a), "attack");
+   EXPECT_GE(nextBit(bits, a + 1), actions.end());
+}
+
+TEST_F(PlannerTest, AbstractActionSet)
+{
+   // Solvers work through the abstract interface as well as with the
+   // concrete ActionSet type, and find the same plans.
+   const ActionSet &abstract = actions;
+   Plan concrete, virt;
+   ASSERT_TRUE(ReverseAstarSolve(init, goal, actions, NoObjects, concrete, ctx));
+   ASSERT_TRUE(ReverseAstarSolve(init, goal, abstract, NoObjects, virt, ctx));
+   EXPECT_TRUE(samePlan(concrete, virt));
+   concrete.clear();
+   virt.clear();
+   ASSERT_TRUE(ForwardAstarSolve(init, goal, actions, NoObjects, concrete, ctx));
+   ASSERT_TRUE(ForwardAstarSolve(init, goal, abstract, NoObjects, virt, ctx));
+   EXPECT_TRUE(samePlan(concrete, virt));
+   EXPECT_TRUE(reachesGoal(virt));
+}
+
+TEST_F(PlannerTest, MaskedRegression)
+{
+   // Only ask for the target to be dead, and start from a fully known state.
+   MaskedWorldState minit(preds), mgoal(preds);
+   minit.set(haveTarget);
+   minit.careAll();
+   mgoal.set(haveTarget);
+   mgoal.set(targetDead);
+
+   Problem<MaskedWorldState> prob;
+   ASSERT_TRUE(ReverseAstarInit(minit, mgoal, prob, ctx));
+   while(ReverseAstarIteration(prob, actions, NoObjects, ctx)) {}
+   ASSERT_TRUE(prob.success);
+   Plan plan;
+   ReverseAstarFinalise(prob, plan, ctx);
+   EXPECT_EQ(length(plan), 4u);
+
+   // The plan must reach the goal when executed.
+   MaskedWorldState ws(minit);
+   Plan::const_iterator it;
+   for(it = plan.begin(); it != plan.end(); it++)
+   {
+      ASSERT_TRUE(actions.preMatch(it->action, it->parameters, ws));
+      actions.applyForward(it->action, it->parameters, ws);
+   }
+   EXPECT_TRUE(ws.satisfies(mgoal));
+
+   // Regressing partial states explores no more than regressing full ones.
+   Problem<SimpleWorldState> full;
+   ASSERT_TRUE(ReverseAstarInit(init, goal, full, ctx));
+   while(ReverseAstarIteration(full, actions, NoObjects, ctx)) {}
+   ASSERT_TRUE(full.success);
+   EXPECT_LE(prob.closed.size(), full.closed.size());
+}
+
+TEST_F(PlannerTest, MaskedRegressionSubsumption)
+{
+   // Let the target be killed with a knife too. Regressing through either
+   // weapon leads to states that ask for more than ones already closed.
+   actions.create("stab");
+   actions.condition(haveTarget, true);
+   actions.condition(targetDead, false);
+   actions.condition(gunLoaded, true);
+   actions.condition(haveGun, true);
+   actions.effect(targetDead, true);
+   actions.cost(2.0f);
+   actions.add();
+
+   MaskedWorldState minit(preds), mgoal(preds);
+   minit.set(haveTarget);
+   minit.careAll();
+   mgoal.set(targetDead);
+
+   Problem<MaskedWorldState> prob;
+   ASSERT_TRUE(ReverseAstarInit(minit, mgoal, prob, ctx));
+   while(ReverseAstarIteration(prob, actions, NoObjects, ctx)) {}
+   ASSERT_TRUE(prob.success);
+   EXPECT_GT(prob.subsumed, 0u);
+   // No closed state may subsume a later one.
+   for(unsigned int i = 0; i < prob.closed.size(); i++)
+      for(unsigned int j = i + 1; j < prob.closed.size(); j++)
+         EXPECT_FALSE(prob.nodes[prob.closed[i]].state->subsumes(*prob.nodes[prob.closed[j]].state));
+   Plan plan;
+   ReverseAstarFinalise(prob, plan, ctx);
+   EXPECT_EQ(length(plan), 4u);
+}
+
+TEST_F(PlannerTest, MaskedRegressionSubsumptionCost)
+{
+   // Two ways to reach x. The more general state {p} is closed first, but
+   // the more specific {p, q} is cheaper to finish from.
+   enum { p, q, u, v, x, COUNT };
+   SimplePredicates cpreds;
+   cpreds.define(COUNT);
+   SimpleActionSet costly(cpreds);
+   costly.create("A1");
+   costly.condition(p, true);
+   costly.effect(x, true);
+   costly.cost(3.0f);
+   costly.add();
+   costly.create("A2");
+   costly.condition(p, true);
+   costly.condition(q, true);
+   costly.effect(x, true);
+   costly.cost(2.75f);
+   costly.add();
+   costly.create("P");
+   costly.condition(u, true);
+   costly.condition(v, true);
+   costly.effect(p, true);
+   costly.add();
+   costly.create("U");
+   costly.effect(u, true);
+   costly.add();
+   costly.create("V");
+   costly.effect(v, true);
+   costly.add();
+   costly.create("Q");
+   costly.effect(p, true);
+   costly.effect(q, true);
+   costly.cost(2.5f);
+   costly.add();
+
+   MaskedWorldState minit(cpreds), mgoal(cpreds);
+   minit.careAll();
+   mgoal.set(x);
+
+   // A closed state only subsumes ones that cost no less to finish from.
+   Plan plan, cheapest;
+   ASSERT_TRUE(ReverseAstarSolve(minit, mgoal, costly, NoObjects, MaxHeuristic(costly), plan, ctx));
+   ASSERT_TRUE(UniformCostSolve(minit, mgoal, costly, NoObjects, cheapest, ctx));
+   ASSERT_EQ(length(plan), 2u);
+   EXPECT_EQ(costly.repr(plan.begin()->action), "Q");
+   EXPECT_TRUE(samePlan(plan, cheapest));
+}
+
+TEST_F(PlannerTest, MaskedGoalForward)
+{
+   MaskedWorldState minit(preds), mgoal(preds);
+   minit.set(haveTarget);
+   minit.careAll();
+   mgoal.set(targetDead);
+   Plan plan;
+   ASSERT_TRUE(ForwardAstarSolve(minit, mgoal, actions, NoObjects, plan, ctx));
+   EXPECT_EQ(length(plan), 4u);
+}
+
+TEST_F(PlannerTest, ReverseAstarStep)
+{
+   Problem<SimpleWorldState> prob;
+   ASSERT_TRUE(ReverseAstarInit(init, goal, prob, ctx));
+   // One iteration at a time must eventually finish.
+   unsigned int steps = 0;
+   SearchStatus status;
+   while((status = ReverseAstarStep(prob, actions, NoObjects, Budget(1), ctx)) == SearchInProgress)
+      steps++;
+   EXPECT_EQ(status, SearchSolved);
+   EXPECT_EQ(steps + 1, prob.closed.size());
+
+   Plan plan;
+   ReverseAstarFinalise(prob, plan, ctx);
+   EXPECT_EQ(length(plan), 4u);
+   EXPECT_TRUE(reachesGoal(plan));
+}
+
+TEST_F(PlannerTest, ForwardAstarStepFails)
+{
+   init.set(targetDead);
+   goal.unset(targetDead);
+   Problem<SimpleWorldState> prob;
+   ASSERT_TRUE(ForwardAstarInit(init, goal, prob, ctx));
+   // A generous time budget lets the search run to completion.
+   EXPECT_EQ(ForwardAstarStep(prob, actions, NoObjects, Budget(0, 1000000), ctx), SearchFailed);
+}
+
+TEST_F(PlannerTest, ReverseAstarClosedIndex)
+{
+   Problem<SimpleWorldState> prob;
+   ASSERT_TRUE(ReverseAstarInit(init, goal, prob, ctx));
+   while(ReverseAstarIteration(prob, actions, NoObjects, ctx)) {}
+   ASSERT_TRUE(prob.success);
+   // Every closed state must be indexed, and no state closed twice.
+   EXPECT_EQ(prob.closedIndex.size(), prob.closed.size());
+   for(unsigned int i = 0; i < prob.closed.size(); i++)
+      EXPECT_EQ(prob.findClosed(*prob.nodes[prob.closed[i]].state), i);
+}
+
+TEST_F(PlannerTest, OpenListDecreaseKey)
+{
+   Problem<SimpleWorldState> prob;
+   prob.reset();
+   // Push states with distinct values and descending costs.
+   for(unsigned int i = 0; i < NUMPREDS; i++)
+   {
+      SimpleWorldState ws(preds);
+      ws.set(i);
+      Problem<SimpleWorldState>::openstate s;
+      s.state = prob.store(ws);
+      s.cost = 10.0f - i;
+      prob.push(s);
+   }
+   // Each state can be found again.
+   for(unsigned int i = 0; i < NUMPREDS; i++)
+   {
+      SimpleWorldState ws(preds);
+      ws.set(i);
+      unsigned int pos = prob.findOpen(ws);
+      ASSERT_NE(pos, HashIndex::None);
+      EXPECT_EQ(prob.nodes[prob.open[pos]].cost, 10.0f - i);
+   }
+   // Make the most expensive state the cheapest.
+   SimpleWorldState ws(preds);
+   ws.set(0);
+   Problem<SimpleWorldState>::openstate better;
+   better.cost = 1.0f;
+   prob.improve(prob.findOpen(ws), better);
+   // States must now come out in order of cost.
+   const Problem<SimpleWorldState>::openstate *s = &prob.nodes[prob.pop()];
+   EXPECT_TRUE(*s->state == ws);
+   EXPECT_EQ(s->cost, 1.0f);
+   float last = s->cost;
+   while(!prob.open.empty())
+   {
+      s = &prob.nodes[prob.pop()];
+      EXPECT_LE(last, s->cost);
+      last = s->cost;
+   }
+   EXPECT_EQ(prob.findOpen(ws), HashIndex::None);
+}
@@ -1,76 +1,105 @@
-/// @file AesopWorldStateTest.h
-/// gtest cases for WorldState class.
+/// @file AesopSimpleWorldStateTest.h
+/// gtest cases for SimpleWorldState class.
 
+#include <set>
 #include "gtest/gtest.h"
-#include "AesopWorldState.h"
+#include "AesopSimplePredicates.h"
+#include "AesopSimpleWorldState.h"
 
 using namespace Aesop;
 
-/// Test fixture for the WorldState class.
+/// Test fixture for the SimpleWorldState class. Uses enough predicates to
+/// span several words of storage.
 /// @ingroup AesopTest
 class SimpleWorldStateTest : public ::testing::Test {
 protected:
+   enum {
+      NUMPREDS = 150
+   };
+
+   SimplePredicates preds;
    SimpleWorldState ws1;
    SimpleWorldState ws2;
 
-   WorldStateTest()
-      :pn1("pred1"),
-      pn2("pred2"),
-      ptrue(1),
-      pfalse(0)
+   SimpleWorldStateTest()
+      : ws1((preds.define(NUMPREDS), preds)),
+      ws2(preds)
    {
    }
 };
 
-TEST_F(WorldStateTest, Predicates)
+TEST_F(SimpleWorldStateTest, Predicates)
 {
-   // Assign a value to a predicate.
-   ws1.setPredicate(pn1, ptrue);
-   EXPECT_TRUE(ws1.predicateSet(pn1));
-   EXPECT_EQ(ws1.getPredicate(pn1), ptrue);
-   // Overwrite the value of a predicate.
-   ws1.setPredicate(pn1, pfalse);
-   EXPECT_TRUE(ws1.predicateSet(pn1));
-   EXPECT_EQ(ws1.getPredicate(pn1), pfalse);
-   // Test a second predicate. Ensure previous values untouched.
-   ws1.setPredicate(pn2, ptrue);
-   EXPECT_TRUE(ws1.predicateSet(pn2));
-   EXPECT_EQ(ws1.getPredicate(pn2), ptrue);
-   EXPECT_TRUE(ws1.predicateSet(pn1));
-   EXPECT_EQ(ws1.getPredicate(pn1), pfalse);
-   // Unset one predicate.
-   ws1.unsetPredicate(pn1);
-   EXPECT_FALSE(ws1.predicateSet(pn1));
-   EXPECT_EQ(ws1.getPredicate(pn1), 0);
-   EXPECT_TRUE(ws1.predicateSet(pn2));
-   EXPECT_EQ(ws1.getPredicate(pn2), ptrue);
+   // Set predicates either side of a word boundary.
+   ws1.set(63);
+   ws1.set(64);
+   EXPECT_TRUE(ws1.isSet(63));
+   EXPECT_TRUE(ws1.isSet(64));
+   EXPECT_FALSE(ws1.isSet(62));
+   EXPECT_FALSE(ws1.isSet(65));
+   // Unset one predicate. Ensure the other is untouched.
+   ws1.unset(63);
+   EXPECT_FALSE(ws1.isSet(63));
+   EXPECT_TRUE(ws1.isUnset(63));
+   EXPECT_TRUE(ws1.isSet(64));
+   // Predicates out of range are never set.
+   ws1.set(NUMPREDS);
+   EXPECT_FALSE(ws1.isSet(NUMPREDS));
 }
 
-TEST_F(WorldStateTest, Comparison)
+TEST_F(SimpleWorldStateTest, Comparison)
 {
-   // By default WorldStates should be equal with no predicates set.
-   EXPECT_EQ(WorldState::comp(ws1, ws2), 0);
+   // By default states should be equal with no predicates set.
+   EXPECT_EQ(ws1.compare(ws2), 0u);
    // A predicate set in one but not the other is a difference.
-   ws1.setPredicate(pn1, ptrue);
-   EXPECT_EQ(WorldState::comp(ws1, ws2), 1);
-   // A predicate set to different values is a difference.
-   ws2.setPredicate(pn1, pfalse);
-   EXPECT_EQ(WorldState::comp(ws1, ws2), 1);
-   // Introduce a second predicate.
-   ws2.setPredicate(pn2, pfalse);
-   EXPECT_EQ(WorldState::comp(ws1, ws2), 2);
+   ws1.set(0);
+   EXPECT_EQ(ws1.compare(ws2), 1u);
+   // Differences in every word are counted.
+   ws2.set(100);
+   ws2.set(NUMPREDS - 1);
+   EXPECT_EQ(ws1.compare(ws2), 3u);
+   EXPECT_EQ(ws2.compare(ws1), 3u);
 }
 
-TEST_F(WorldStateTest, Equality)
+TEST_F(SimpleWorldStateTest, Equality)
 {
-   // By default WorldStates should be equal.
+   // By default states should be equal.
    EXPECT_TRUE(ws1 == ws2);
+   EXPECT_EQ(ws1.hash(), ws2.hash());
    // Introduce a predicate to one that makes them no longer equal.
-   ws1.setPredicate(pn1, ptrue);
+   ws1.set(127);
    EXPECT_FALSE(ws1 == ws2);
    // Restore equality in the other.
-   ws2.setPredicate(pn1, ptrue);
+   ws2.set(127);
    EXPECT_TRUE(ws1 == ws2);
+   EXPECT_EQ(ws1.hash(), ws2.hash());
    // Test !=, but its correctness should follow the correctness of ==.
    EXPECT_FALSE(ws1 != ws2);
+   // Setting and unsetting restores the original hash.
+   statehash h = ws1.hash();
+   ws1.set(3);
+   EXPECT_NE(ws1.hash(), h);
+   ws1.unset(3);
+   EXPECT_EQ(ws1.hash(), h);
+}
+
+TEST_F(SimpleWorldStateTest, Hash)
+{
+   // Every state with a single predicate set hashes differently.
+   std::set<statehash> hashes;
+   hashes.insert(ws1.hash());
+   for(unsigned int p = 0; p < NUMPREDS; p++)
+   {
+      ws1.set(p);
+      hashes.insert(ws1.hash());
+      ws1.unset(p);
+   }
+   EXPECT_EQ(hashes.size(), NUMPREDS + 1u);
+   // The hash doesn't depend on the order predicates were set in, and
+   // agrees with one computed from the whole state.
+   ws1.set(5); ws1.set(70); ws1.set(149);
+   ws2.set(149); ws2.set(5); ws2.set(70);
+   EXPECT_EQ(ws1.hash(), ws2.hash());
+   ws2.bitsChanged();
+   EXPECT_EQ(ws1.hash(), ws2.hash());
 }
@@ -0,0 +1,74 @@
+/// @file AesopStaticWorldStateTest.h
+/// gtest cases for StaticWorldState class template.
+
+#include "gtest/gtest.h"
+#include "AesopSimplePredicates.h"
+#include "AesopStaticWorldState.h"
+
+using namespace Aesop;
+
+/// Test fixture for the StaticWorldState class. Uses enough predicates to
+/// span several words of storage.
+/// @ingroup AesopTest
+class StaticWorldStateTest : public ::testing::Test {
+protected:
+   enum {
+      NUMPREDS = 150
+   };
+
+   typedef StaticWorldState<NUMPREDS> state;
+
+   SimplePredicates preds;
+   state ws1;
+   state ws2;
+
+   StaticWorldStateTest()
+      : ws1((preds.define(NUMPREDS), preds)),
+      ws2(preds)
+   {
+   }
+};
+
+TEST_F(StaticWorldStateTest, Storage)
+{
+   // Storage is sized at compile time.
+   EXPECT_EQ(state::words, 3u);
+   EXPECT_EQ(state::word(64), 1u);
+   EXPECT_EQ(state::mask(65), 2u);
+   EXPECT_EQ(StaticWorldState<64>::words, 1u);
+}
+
+TEST_F(StaticWorldStateTest, Predicates)
+{
+   // Set predicates either side of a word boundary.
+   ws1.set(63);
+   ws1.set(64);
+   EXPECT_TRUE(ws1.isSet(63));
+   EXPECT_TRUE(ws1.isSet(64));
+   EXPECT_FALSE(ws1.isSet(62));
+   EXPECT_FALSE(ws1.isSet(65));
+   // Unset one predicate. Ensure the other is untouched.
+   ws1.unset(63);
+   EXPECT_FALSE(ws1.isSet(63));
+   EXPECT_TRUE(ws1.isUnset(63));
+   EXPECT_TRUE(ws1.isSet(64));
+   // Predicates out of range are never set.
+   ws1.set(NUMPREDS);
+   EXPECT_FALSE(ws1.isSet(NUMPREDS));
+}
+
+TEST_F(StaticWorldStateTest, Equality)
+{
+   EXPECT_TRUE(ws1 == ws2);
+   EXPECT_EQ(ws1.hash(), ws2.hash());
+   ws1.set(127);
+   ws1.set(0);
+   EXPECT_FALSE(ws1 == ws2);
+   EXPECT_EQ(ws1.compare(ws2), 2u);
+   // Copies are independent of the original.
+   state ws3(ws1);
+   EXPECT_TRUE(ws3 == ws1);
+   ws3.unset(127);
+   EXPECT_TRUE(ws1.isSet(127));
+   EXPECT_EQ(ws3.compare(ws2), 1u);
+}
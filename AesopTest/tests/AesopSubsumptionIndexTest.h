@@ -0,0 +1,112 @@
+/// @file AesopSubsumptionIndexTest.h
+/// gtest cases for SubsumptionIndex class.
+
+#include "gtest/gtest.h"
+#include "AesopSubsumptionIndex.h"
+
+using namespace Aesop;
+
+/// Test fixture for the SubsumptionIndex class.
+/// @ingroup AesopTest
+class SubsumptionIndexTest : public ::testing::Test {
+protected:
+   SubsumptionIndex index;
+
+   SubsumptionIndexTest()
+   {
+   }
+};
+
+TEST_F(SubsumptionIndexTest, Empty)
+{
+   SubsumptionIndex::literals set;
+   EXPECT_EQ(index.size(), 0u);
+   EXPECT_FALSE(index.subsumed(set));
+   // The empty set is a subset of everything.
+   index.insert(set);
+   EXPECT_EQ(index.size(), 1u);
+   set.push_back(3);
+   EXPECT_TRUE(index.subsumed(set));
+}
+
+TEST_F(SubsumptionIndexTest, Subsets)
+{
+   SubsumptionIndex::literals a, b, q;
+   a.push_back(2); a.push_back(5); a.push_back(9);
+   b.push_back(2); b.push_back(7);
+   index.insert(a);
+   index.insert(b);
+   // Inserting a set twice stores it once.
+   index.insert(b);
+   EXPECT_EQ(index.size(), 2u);
+
+   // Stored sets subsume themselves.
+   EXPECT_TRUE(index.subsumed(a));
+   EXPECT_TRUE(index.subsumed(b));
+   // A strict superset of a stored set, with literals either side.
+   q.push_back(1); q.push_back(2); q.push_back(5); q.push_back(6); q.push_back(9); q.push_back(12);
+   EXPECT_TRUE(index.subsumed(q));
+   // A query that shares a prefix with both sets, but contains neither.
+   q.clear();
+   q.push_back(2); q.push_back(5); q.push_back(8);
+   EXPECT_FALSE(index.subsumed(q));
+   // A subset of a stored set isn't subsumed.
+   q.clear();
+   q.push_back(2);
+   EXPECT_FALSE(index.subsumed(q));
+
+   // Clearing forgets everything.
+   index.clear();
+   EXPECT_EQ(index.size(), 0u);
+   EXPECT_FALSE(index.subsumed(a));
+}
+
+TEST_F(SubsumptionIndexTest, Supersets)
+{
+   SubsumptionIndex::literals a, b, q;
+   EXPECT_FALSE(index.subsumes(q));
+   a.push_back(2); a.push_back(5); a.push_back(9);
+   b.push_back(2); b.push_back(7);
+   index.insert(a, 4.0f);
+   index.insert(b, 1.0f);
+
+   // Stored sets and their subsets, including the empty set, are found
+   // whatever they cost.
+   EXPECT_TRUE(index.subsumes(q));
+   EXPECT_TRUE(index.subsumes(a));
+   q.push_back(5); q.push_back(9);
+   EXPECT_TRUE(index.subsumes(q));
+   q.clear();
+   q.push_back(7);
+   EXPECT_TRUE(index.subsumes(q));
+   // Literals from different stored sets.
+   q.clear();
+   q.push_back(5); q.push_back(7);
+   EXPECT_FALSE(index.subsumes(q));
+   // A literal past the end of every stored set.
+   q.clear();
+   q.push_back(2); q.push_back(12);
+   EXPECT_FALSE(index.subsumes(q));
+}
+
+TEST_F(SubsumptionIndexTest, Costs)
+{
+   SubsumptionIndex::literals a, b, q;
+   a.push_back(3);
+   b.push_back(3); b.push_back(4);
+   index.insert(a, 3.0f);
+   index.insert(b, 5.0f);
+   q.push_back(3); q.push_back(4); q.push_back(6);
+
+   // Only stored sets that cost no more than the query count.
+   EXPECT_TRUE(index.subsumed(q, 3.0f));
+   EXPECT_FALSE(index.subsumed(q, 2.75f));
+   EXPECT_TRUE(index.subsumed(b, 5.0f));
+   // A set stored again keeps its cheaper cost.
+   index.insert(b, 2.0f);
+   EXPECT_EQ(index.size(), 2u);
+   EXPECT_TRUE(index.subsumed(q, 2.75f));
+   EXPECT_FALSE(index.subsumed(q, 1.0f));
+   index.insert(b, 4.0f);
+   EXPECT_TRUE(index.subsumed(q, 2.0f));
+}